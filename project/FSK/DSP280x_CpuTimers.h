@@ -125,7 +125,8 @@ extern volatile struct CPUTIMER_REGS CpuTimer0Regs;
 extern struct CPUTIMER_VARS CpuTimer0;
 
 // CpuTimer 1 and CpuTimer2 are reserved for DSP BIOS & other RTOS
-//extern volatile struct CPUTIMER_REGS CpuTimer1Regs;
+// CpuTimer1 is the free-running cycle counter of this firmware (load.c), which runs without BIOS.
+extern volatile struct CPUTIMER_REGS CpuTimer1Regs;
 //extern volatile struct CPUTIMER_REGS CpuTimer2Regs;
 
 //extern struct CPUTIMER_VARS CpuTimer1;
@@ -154,26 +155,27 @@ extern struct CPUTIMER_VARS CpuTimer0;
 // DSP-BIOS or another realtime OS. 
 //
 // For this reason, the code to manipulate these two timers is
-// commented out and not used in these examples.
+// commented out and not used in these examples.  CpuTimer1 is enabled
+// for the cycle counter (load.c).
 
 // Start Timer:
-//#define StartCpuTimer1()  CpuTimer1Regs.TCR.bit.TSS = 0
+#define StartCpuTimer1()  CpuTimer1Regs.TCR.bit.TSS = 0
 //#define StartCpuTimer2()  CpuTimer2Regs.TCR.bit.TSS = 0
 
 // Stop Timer:
-//#define StopCpuTimer1()   CpuTimer1Regs.TCR.bit.TSS = 1
+#define StopCpuTimer1()   CpuTimer1Regs.TCR.bit.TSS = 1
 //#define StopCpuTimer2()   CpuTimer2Regs.TCR.bit.TSS = 1
 
 // Reload Timer With period Value:
-//#define ReloadCpuTimer1() CpuTimer1Regs.TCR.bit.TRB = 1
+#define ReloadCpuTimer1() CpuTimer1Regs.TCR.bit.TRB = 1
 //#define ReloadCpuTimer2() CpuTimer2Regs.TCR.bit.TRB = 1
 
 // Read 32-Bit Timer Value:
-//#define ReadCpuTimer1Counter() CpuTimer1Regs.TIM.all
+#define ReadCpuTimer1Counter() CpuTimer1Regs.TIM.all
 //#define ReadCpuTimer2Counter() CpuTimer2Regs.TIM.all
 
 // Read 32-Bit Period Value:
-//#define ReadCpuTimer1Period() CpuTimer1Regs.PRD.all
+#define ReadCpuTimer1Period() CpuTimer1Regs.PRD.all
 //#define ReadCpuTimer2Period() CpuTimer2Regs.PRD.all
 
 
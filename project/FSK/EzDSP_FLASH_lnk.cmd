@@ -22,6 +22,7 @@
 //		| 07 Feb 2003 | M.H. | Modified map to make space for RAMSFUNCS in flash/RAM.
 //      | 07 Oct 2004 | M.H. | Reconcile with RAM version. 
 //      |             |      | Shrunk OTP from 2k to 1k to match documentation.
+//      | 19 Oct 2026 |      | ramfuncs start and end symbols for BootCopy().
 // -----|-------------|------|-----------------------------------------------
 //###########################################################################
 */
@@ -106,7 +107,11 @@ SECTIONS
    .text      		: > FLASHA,      	PAGE = 0
    .cinit     		: > FLASHA,      	PAGE = 0
    .flashreset 		: > FLASHRESET, 	PAGE = 0
-   ramfuncs    		: LOAD > FLASHB, RUN > PRAMH0, PAGE = 0
+   ramfuncs    		: LOAD > FLASHB, RUN > PRAMH0, 		/* functions listed in ramfuncs.h */
+                      LOAD_START(_RamfuncsLoadStart),		/* addresses for BootCopy() */
+                      LOAD_END(_RamfuncsLoadEnd),
+                      RUN_START(_RamfuncsRunStart),
+                      PAGE = 0
 
    .const      		: > FLASHA,			PAGE = 0 	/* Put this is different section than fir_databuff to speed up FIR*/
    .econst      	: > FLASHA,      	PAGE = 0      
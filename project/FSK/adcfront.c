@@ -0,0 +1,368 @@
+//==========================================================================================
+// Filename:		adcfront.c
+//
+// Description:		C reference for the receive front end SmoothADCResults() in subs.asm.
+//					Combines the OVERSAMPLE_RATE ADC conversions of one receive sample
+//					into a signed value, as configured in adcfront.h.
+//
+//					The trimmed mean and the mean are bit exact with the assembly version,
+//					so the host build (MEX_COMPILE) sees the same samples as the target.
+//					The median is only done here; on the target SmoothADCResults()
+//					branches to this function for ADC_FRONT_MEDIAN.
+//
+//					RxDemod() is the rest of the receive path of the ADC ISR up to
+//					receive(): impulse blanker and delay-multiply demodulator.  The host
+//					build calls the same function, so golden vectors (golden.c) check the
+//					fixed-point arithmetic of the whole receive chain.  BlankCheck() (host
+//					build) checks that a preamble after silence gets through the blanker.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Impulse blanker ImpulseBlank(), passes sustained levels; BlankCheck().
+// 19Oct26			RxDemod() moved here from adc_isr().
+// 19Oct26			RxDemodReset() for the golden vector checks.
+//==========================================================================================
+
+#include "main.h"
+#ifdef MEX_COMPILE
+#include <math.h>						// sin(), floor() for BlankCheck()
+#endif
+
+#define	RAMFUNCS_ADCFRONT						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+//---- impulse blanker ------------------------------------------
+#define	BLANK_FLOOR_SHIFT	8			// noise floor time constant = 2^8 samples (~4 ms)
+#define	BLANK_FACTOR		6			// blank samples above this multiple of the mean |sample|
+#define	BLANK_MIN_LEVEL		2048		// never blank below this level
+#define	BLANK_CLAMP			False		// True: clamp to the threshold, False: zero the sample
+#define	BLANK_WIN_SHIFT		5			// sustained level window = 2^5 samples (~0.5 ms)
+#define	BLANK_SUSTAINED		(((3 << 8) << BLANK_WIN_SHIFT) / 4)	// 3/4 of the window above
+										// the threshold is a signal, not an impulse
+#define	BLANK_CHECK_SILENCE	2000		// BlankCheck(): samples of silence before the preamble
+#define	BLANK_CHECK_BURST	12			// BlankCheck(): samples of the impulse burst (200 us)
+#define	BLANK_CHECK_TONE	600			// BlankCheck(): samples of preamble
+#define	BLANK_CHECK_LOST	64			// BlankCheck(): preamble samples it may blank
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+s16		ADCsample[ADCINT_COUNT_MAX];	// receive samples, for the delayed product
+u32		ulBlankFloor = 0;				// mean |sample| scaled by 2^BLANK_FLOOR_SHIFT
+u32		ulBlankFast = 0;				// mean |sample| over the window, scaled by 2^BLANK_WIN_SHIFT
+u16		uBlankAbove = 0;				// share of the window above the threshold, Q8 scaled by
+										// 2^BLANK_WIN_SHIFT
+u16		uBlanking = False;				// Flag: previous sample was blanked
+
+
+//==========================================================================================
+// Function:		AdcFrontEnd()
+//
+// Description: 	Convert the raw ADC results to signed values and combine them.
+//
+//					ADC_FRONT_TRIM		sum - highest - lowest, divided by (N-2)
+//					ADC_FRONT_MEAN		sum divided by N
+//					ADC_FRONT_MEDIAN	middle value (mean of the middle two for even N)
+//
+//					Division is a multiply by the Q12 reciprocal ADC_FRONT_RECIP followed
+//					by an arithmetic shift, the same as in subs.asm.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+s16 AdcFrontEnd(const u16 *upResult)
+{
+	s16		sSample[OVERSAMPLE_RATE];	// signed ADC results
+	u16		i;							// Generic loop counter
+	s32		lSum;						// Sum of all results
+
+#if (ADC_FRONT_MODE == ADC_FRONT_MEDIAN)
+	u16		j;
+	s16		sTemp;
+
+	//---- insertion sort, the burst is at most 16 samples ----
+	for (i=0; i<OVERSAMPLE_RATE; i++)
+	{
+		sTemp = (s16)(upResult[i] - 0x8000U);
+		for (j=i; (j > 0) && (sSample[j-1] > sTemp); j--)
+		{
+			sSample[j] = sSample[j-1];
+		}
+		sSample[j] = sTemp;
+	}
+
+	#if (OVERSAMPLE_RATE & 1)
+		return sSample[OVERSAMPLE_RATE/2];
+	#else
+		lSum = (s32)sSample[OVERSAMPLE_RATE/2 - 1] + sSample[OVERSAMPLE_RATE/2];
+		return (s16)(lSum >> 1);
+	#endif
+
+#else
+	s16		sHigh;						// Highest value in ADC results set
+	s16		sLow;						// Lowest value in ADC results set
+
+	sHigh = -32767-1;
+	sLow  =  32767;
+	lSum  = 0;
+
+	for (i=0; i<OVERSAMPLE_RATE; i++)
+	{
+		sSample[i] = (s16)(upResult[i] - 0x8000U);	// Convert to signed
+		sHigh = Max(sHigh, sSample[i]);
+		sLow  = Min(sLow,  sSample[i]);
+		lSum += sSample[i];
+	}
+
+	#if (ADC_FRONT_MODE == ADC_FRONT_TRIM)
+		lSum = lSum - sHigh - sLow;				// Strip out the highest and lowest samples
+	#endif
+
+	return (s16)((lSum * ADC_FRONT_RECIP) >> ADC_FRONT_RECIP_SCALE);
+#endif
+}
+
+
+//==========================================================================================
+// Function:		ImpulseBlank()
+//
+// Description: 	Impulse blanker: returns sSample, or 0 if it is far above the tracked
+//					noise floor.  One spike would otherwise sit in demodBuf for a whole
+//					window.  Blanked samples enter the floor at the threshold, so an
+//					impulse does not raise it.
+//
+//					The floor follows slowly (2^BLANK_FLOOR_SHIFT samples), so a signal
+//					starting after silence is above the threshold for a long time.  Over
+//					the shorter window of 2^BLANK_WIN_SHIFT samples the blanker tracks
+//					the share of samples above the threshold and their mean level.  Once
+//					BLANK_SUSTAINED of the window is above, the level is a signal: the
+//					floor is set to the window mean (not the peak) and the samples pass.
+//					The leaky share crosses 3/4 after about 44 samples above, so impulse
+//					bursts up to ~0.7 ms stay blanked and leave the floor where it was;
+//					a preamble after silence loses about as many samples.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Blanked samples counted per mains phase bin (ZC_SYNC).
+//==========================================================================================
+s16 ImpulseBlank(s16 sSample)
+{
+	s16		sAbs;						// |ADC sample|
+	s32		lBlankThrs;					// blanking threshold
+
+	sAbs = sSample;
+	if( sAbs < 0 )
+		sAbs = (sAbs == -32767-1) ? 32767 : -sAbs;
+	lBlankThrs = (ulBlankFloor >> BLANK_FLOOR_SHIFT) * BLANK_FACTOR;
+	if( lBlankThrs < BLANK_MIN_LEVEL )
+		lBlankThrs = BLANK_MIN_LEVEL;
+
+	//---- window statistics, blanked samples included ---------------
+	ulBlankFast += sAbs - (ulBlankFast >> BLANK_WIN_SHIFT);
+	uBlankAbove += ((sAbs > lBlankThrs) ? (1 << 8) : 0) - (uBlankAbove >> BLANK_WIN_SHIFT);
+
+	if( (sAbs > lBlankThrs) && (uBlankAbove >= BLANK_SUSTAINED) )
+	{
+		ulBlankFloor = (ulBlankFast >> BLANK_WIN_SHIFT) << BLANK_FLOOR_SHIFT;	// a signal
+		uBlanking = False;
+	}
+	else if( sAbs > lBlankThrs )
+	{
+		#if BLANK_CLAMP == True
+		sSample = (sSample < 0) ? -(s16)lBlankThrs : (s16)lBlankThrs;
+		#else
+		sSample = 0;
+		#endif
+		sAbs = (s16)lBlankThrs;			// don't let the impulse raise the floor
+
+		ulPlcStats[RX_BLANKED][plcMode]++;
+		#if ZC_SYNC == True
+		ulZcNoise[uZcBin]++;			// impulse noise per mains phase
+		#endif
+		if( !uBlanking )
+			ulPlcStats[RX_BLANK_BURSTS][plcMode]++;
+		uBlanking = True;
+	}
+	else
+	{
+		uBlanking = False;
+	}
+	ulBlankFloor += sAbs - (ulBlankFloor >> BLANK_FLOOR_SHIFT);
+
+	return (sSample);
+}
+
+
+//==========================================================================================
+// Function:		BlankReset()
+//
+// Description: 	Start the impulse blanker over from silence.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void BlankReset(void)
+{
+	ulBlankFloor = 0;
+	ulBlankFast = 0;
+	uBlankAbove = 0;
+	uBlanking = False;
+}
+
+
+//==========================================================================================
+// Function:		RxDemod()
+//
+// Description: 	One receive sample from the ADC burst to one demod sample for
+//					receive().  Samples far above the tracked noise floor are blanked
+//					(IMPULSE_BLANKER), then the sample is multiplied by the one
+//					QUARTER_PER_DELAY samples earlier and summed over ADCINT_COUNT_MAX
+//					samples (moving sum in demodBuf[]).
+//
+//					With a trace buffer each sample adds two words: the input sample
+//					and the demod output.  receive() adds bitPhase and the mode word,
+//					which makes the four word record read by GoldenCheck().
+//
+// Revision History:
+// 19Oct26			New function, from adc_isr().
+//==========================================================================================
+s16 RxDemod(s16 sSample)
+{
+	s16		sProduct;					// delayed product, scaled
+
+	PROF(PROF_RXDEMOD);					// host call count (prof.c)
+
+	#if TRACE_BUF_LEN > 0
+		#ifdef DSP_COMPILE
+			SaveTraceF( sSample );		// 1st trace var
+		#endif
+	#endif
+	#ifdef MEX_COMPILE
+		GoldenTrace( sSample );
+	#endif
+
+	//---- set receive sample buffer index and delayed index ----------
+	ADCIntCount++;
+	if( ADCIntCount >= ADCINT_COUNT_MAX )
+		ADCIntCount = 0;
+	ADCIntCountDelay = ADCIntCount - QUARTER_PER_DELAY;
+	if( ADCIntCountDelay > (ADCINT_COUNT_MAX - QUARTER_PER_DELAY ))
+		ADCIntCountDelay += ADCINT_COUNT_MAX;
+
+	//---- impulse blanker: remove samples far above the noise floor -------
+	#if IMPULSE_BLANKER == True
+		ADCsample[ADCIntCount] = ImpulseBlank(sSample);
+	#else
+		ADCsample[ADCIntCount] = sSample;
+	#endif
+
+	//---- do demod multiplication & lowpass filter ---------------------
+	demod -= demodBuf[ADCIntCount];
+	sProduct = (s16)( ( (s32)ADCsample[ADCIntCount] * (s32)ADCsample[ADCIntCountDelay] ) >> 16 );
+	sProduct = sProduct >> 3;
+	demodBuf[ADCIntCount] = sProduct;
+	demod += demodBuf[ADCIntCount];
+
+	#if TRACE_BUF_LEN > 0
+		#ifdef DSP_COMPILE
+			SaveTraceF( demod );		// 2nd trace var
+		#endif
+	#endif
+	#ifdef MEX_COMPILE
+		GoldenTrace( demod );
+	#endif
+
+	return demod;
+}
+
+
+//==========================================================================================
+// Function:		RxDemodReset()
+//
+// Description: 	Clear the RxDemod() state: delay line, demod sum, buffer indices and
+//					the impulse blanker.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void RxDemodReset(void)
+{
+	u16		n;
+
+	for (n=0; n<ADCINT_COUNT_MAX; n++)
+	{
+		ADCsample[n] = 0;
+		demodBuf[n] = 0;
+	}
+	demod = 0;
+	ADCIntCount = 0;
+	ADCIntCountDelay = 0;
+	BlankReset();
+}
+
+
+#ifdef MEX_COMPILE
+//==========================================================================================
+// Function:		BlankCheck()
+//
+// Description: 	Host check of ImpulseBlank().  BLANK_CHECK_SILENCE samples of silence
+//					carry a single impulse, then a 200 us impulse burst, then another
+//					single impulse; all three must be blanked (the burst must not lift
+//					the floor).  A preamble follows (TX_FREQ_m, half scale), which must
+//					lose no more than BLANK_CHECK_LOST samples.  Leaves the blanker
+//					reset.  Returns the number of failed checks.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 BlankCheck(void)
+{
+	u16		uBad = 0;
+	u16		uPassed = 0;				// impulse samples not blanked
+	u16		uLost = 0;					// preamble samples blanked
+	s16		sIn;
+	u16		n;
+
+	BlankReset();
+
+	for (n=0; n<BLANK_CHECK_SILENCE; n++)
+	{
+		sIn = 0;
+		if ( (n == BLANK_CHECK_SILENCE/4) || (n == 3*BLANK_CHECK_SILENCE/4) ||
+			 ((n >= BLANK_CHECK_SILENCE/2) && (n < BLANK_CHECK_SILENCE/2 + BLANK_CHECK_BURST)) )
+			sIn = (n & 1) ? 20000 : -20000;
+		if (ImpulseBlank(sIn) != 0)
+			uPassed++;
+	}
+	for (n=0; n<BLANK_CHECK_TONE; n++)
+	{
+		sIn = (s16)floor(16384.0 * sin(2.0 * 3.14159265358979 * TX_FREQ_m / RX_Sampling * n) + 0.5);
+		if (ImpulseBlank(sIn) != sIn)
+			uLost++;
+	}
+
+	if (uPassed != 0)
+	{
+		mexPrintf("blank: %u impulse samples not blanked\n", uPassed);
+		uBad++;
+	}
+	if (uLost > BLANK_CHECK_LOST)
+	{
+		mexPrintf("blank: %u of %u preamble samples blanked\n", uLost, BLANK_CHECK_TONE);
+		uBad++;
+	}
+	mexPrintf("blank: preamble lost %u samples, %u checks failed\n", uLost, uBad);
+
+	BlankReset();
+	return (uBad);
+}
+#endif
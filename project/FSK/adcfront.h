@@ -0,0 +1,57 @@
+//==========================================================================================
+// Filename:		adcfront.h
+//
+// Description:		Receive front end configuration.
+//					Each receive sample is made from a burst of OVERSAMPLE_RATE conversions
+//					taken by the ADC sequencer (see ArmAllSensors()).  The burst is combined
+//					into one signed sample by SmoothADCResults() in subs.asm, or by its C
+//					reference AdcFrontEnd() in adcfront.c.
+//
+//					This file is included by main.h and by subs.asm (.cdecls), so it may
+//					only contain preprocessor definitions.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.  OVERSAMPLE_RATE was defined in both sensor.c and subs.asm.
+// 19Oct26			ADC_FRONT_RECIP rounded down.
+//==========================================================================================
+
+#ifndef adcfront_h							// Header file guard
+#define adcfront_h
+
+
+//---- number of ADC conversions per receive sample (3..16) ------------------
+#define	OVERSAMPLE_RATE			4
+#define	ADC_RX_CHANNEL			6		// ADC input with the receive signal
+
+//---- how the burst is combined into one sample -----------------------------
+#define	ADC_FRONT_TRIM			0		// drop highest and lowest, average the rest
+#define	ADC_FRONT_MEAN			1		// average all (boxcar, first order CIC decimation)
+#define	ADC_FRONT_MEDIAN		2		// median of the burst (C version on the target too)
+
+#define	ADC_FRONT_MODE			ADC_FRONT_TRIM
+
+
+//---- derived constants: the average is taken by a Q12 reciprocal multiply ---
+#if (OVERSAMPLE_RATE < 3) || (OVERSAMPLE_RATE > 16)
+	#error "OVERSAMPLE_RATE must be 3..16 (ADC sequencer length)"
+#endif
+
+#if ADC_FRONT_MODE == ADC_FRONT_TRIM
+	#define	ADC_FRONT_DIV		(OVERSAMPLE_RATE-2)
+#else
+	#define	ADC_FRONT_DIV		(OVERSAMPLE_RATE)
+#endif
+
+// The reciprocal is exact only when ADC_FRONT_DIV is a power of two.  For the other
+// lengths it is rounded down, so the front end gain is ADC_FRONT_RECIP*DIV/4096 (down
+// to -0.2% for DIV 14: 292*14 = 4088) and a full scale burst cannot overflow s16.
+// Rounding to nearest gave 293*14 = 4102, which wrapped at negative full scale.
+#define	ADC_FRONT_RECIP_SCALE	12
+#define	ADC_FRONT_RECIP			((1<<ADC_FRONT_RECIP_SCALE) / ADC_FRONT_DIV)
+
+
+#endif	// file guard
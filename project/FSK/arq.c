@@ -0,0 +1,545 @@
+//==========================================================================================
+// Filename:		arq.c
+//
+// Description:		Reliable command delivery over the power line (selective repeat ARQ).
+//
+//					CMD_PLC_RELIABLE queues a command for a remote node into one of
+//					ARQ_WINDOW transmit slots and returns at once, so the host can queue
+//					the next command without waiting for the remote.  Each frame carries
+//					a sequence number per destination; the receiver acks in the style of
+//					CMD_ECHO_ACK with the first sequence number it is missing and a mask
+//					of the frames it already holds after that.  Unacked frames are sent
+//					again after a timeout derived from the frame airtime.  The receiver
+//					buffers frames that arrive out of order and executes the commands
+//					in sequence.
+//
+//					Data frame (bytes):	dest hi, dest lo, CMD_ARQ_DATA, src hi, src lo,
+//										epoch, seq, low, command (ARQ_PAYLOAD_LEN bytes)
+//					Ack frame (bytes):	dest hi, dest lo, CMD_ARQ_ACK, src hi, src lo,
+//										next seq, mask (bit n = next seq + 1 + n received)
+//
+//					"low" is the oldest sequence number the sender still holds for the
+//					receiver.  The receiver skips frames before it (dropped after the
+//					last retry), and restarts its window there if it has lost its state.
+//
+//					The sender keeps the next sequence number per destination in arqDest[],
+//					whose entries are not reused while frames to them are in flight.  A
+//					new entry starts at sequence 0 with a new epoch; the receiver restarts
+//					its window whenever the epoch changes, so a sender that forgot a
+//					destination (or was reset) is not mistaken for one repeating old frames.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Sequence numbers in arqDest[] instead of the link table; sender epoch.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	ARQ_HDR_LEN			8			// bytes ahead of the command in a data frame
+#define	ARQ_ACK_LEN			7			// bytes in an ack frame
+#define	ARQ_PAYLOAD_LEN		(MAX_TX_MSG_LEN - ARQ_HDR_LEN)	// command bytes per frame
+#define	ARQ_SEQ_MASK		0x00FF		// sequence numbers are one byte
+#define	ARQ_RETRY_MAX		5			// sends after the first before a frame is dropped
+#define	ARQ_PEERS			2			// senders tracked by the receiver
+#define	ARQ_DESTS			8			// destinations tracked by the sender (> ARQ_WINDOW)
+
+enum {ARQ_FREE, ARQ_QUEUED, ARQ_SENT};	// transmit slot states
+
+//---- timeout: airtime of the frame and its ack, the receiver's hold off, and a margin ----
+#define	ARQ_HOLDOFF_TICKS		((u32)((11*21*2 + 0x7FF) * TINTS_PER_SEC / RX_Sampling) + 1)
+#define	ARQ_MARGIN_TICKS		(TINTS_PER_SEC/50)		// 20 ms for the main loops
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	u16				uState;			// ARQ_FREE, ARQ_QUEUED or ARQ_SENT
+	u16				uDest;			// destination address
+	u16				uSeq;			// sequence number
+	u16				uTries;			// times sent
+	u32				ulSentAt;		// CpuTimer0 count at the last send
+	u32				ulTimeout;		// ticks to wait for the ack
+	u16				upData[ARQ_PAYLOAD_LEN];	// command, one byte per word
+}	arqSlot;
+
+typedef struct
+{
+	u16				uAddr;			// destination address, 0xFFFF = unused
+	u16				uSeq;			// next sequence number to this destination
+	u16				uEpoch;			// epoch sent with the sequence numbers
+	u16				uUsed;			// queue count at the last frame, for reuse
+}	arqDest;
+
+typedef struct
+{
+	u16				uAddr;			// sender address, 0xFFFF = unused
+	u16				uEpoch;			// sender's epoch for this window
+	u16				uBase;			// next sequence number to execute
+	u16				uMask;			// bit n: frame uBase+n is buffered
+	u16				uLow;			// oldest sequence number the sender still holds
+	u16				uAckPending;	// Flag: send an ack to this sender
+	u16				uUsed;			// receive count at the last frame, for reuse
+	u16				upBuf[ARQ_WINDOW][ARQ_PAYLOAD_LEN];	// frames by sequence number
+}	arqPeer;
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u32		ulArqStats[ARQ_STATS_LEN/2];	// Statistics for reliable delivery
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+arqSlot		arqTx[ARQ_WINDOW];			// transmit window
+arqPeer		arqRx[ARQ_PEERS];			// receive windows
+u16			uArqRxCount = 0;			// frames received, for peer reuse
+arqDest		arqDst[ARQ_DESTS];			// sequence numbers per destination
+u16			uArqTxCount = 0;			// frames queued, for destination reuse
+u16			uArqEpoch = 0;				// epoch of the newest arqDst[] entry
+
+
+//==========================================================================================
+// Function:		ArqInit()
+//
+// Description: 	Empty the transmit and receive windows.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ArqInit(void)
+{
+	u16		i;
+
+	memset(arqTx, 0, sizeof(arqTx));
+	memset(arqRx, 0, sizeof(arqRx));
+	memset(arqDst, 0, sizeof(arqDst));
+	for (i=0; i<ARQ_PEERS; i++)
+	{
+		arqRx[i].uAddr = 0xFFFF;
+	}
+	for (i=0; i<ARQ_DESTS; i++)
+	{
+		arqDst[i].uAddr = 0xFFFF;
+	}
+	memset(ulArqStats, 0, sizeof(ulArqStats));
+}
+
+
+//==========================================================================================
+// Function:		ArqDestFind()
+//
+// Description: 	Returns the sequence number entry for uDest.  A new destination takes
+//					an unused entry, or the least recently used one without frames in
+//					flight (there are more entries than transmit slots).  It starts at
+//					sequence 0 with a new epoch: a step of 1 - 128 from the last one, by
+//					the cycle counter, so it also differs from the epoch before a reset.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static arqDest *ArqDestFind(u16 uDest)
+{
+	u16			i, n;
+	arqDest		*pDest;
+	arqDest		*pOldest = 0;
+
+	for (i=0; i<ARQ_DESTS; i++)
+	{
+		pDest = &arqDst[i];
+		if (pDest->uAddr == uDest)
+			return (pDest);
+
+		for (n=0; n<ARQ_WINDOW; n++)
+		{
+			if ((arqTx[n].uState != ARQ_FREE) && (arqTx[n].uDest == pDest->uAddr))
+				break;
+		}
+		if (n < ARQ_WINDOW)
+			continue;					// frames in flight: keep the entry
+		if ( (pOldest == 0) || (pDest->uAddr == 0xFFFF) ||
+			 ((pOldest->uAddr != 0xFFFF) &&
+			  ((u16)(uArqTxCount - pDest->uUsed) > (u16)(uArqTxCount - pOldest->uUsed))) )
+			pOldest = pDest;
+	}
+
+	uArqEpoch = (uArqEpoch + 1 + ((u16)CYCLE_COUNT() & 0x007F)) & ARQ_SEQ_MASK;
+	pOldest->uAddr = uDest;
+	pOldest->uSeq = 0;
+	pOldest->uEpoch = uArqEpoch;
+	pOldest->uUsed = uArqTxCount;
+	return (pOldest);
+}
+
+
+//==========================================================================================
+// Function:		ArqQueue()
+//
+// Description: 	Queue a command (upCmd[0] = command number, one byte per word) for
+//					uDest.  Returns the sequence number, or ARQ_BUSY if the window is full.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 ArqQueue(u16 uDest, const u16 *upCmd, u16 uLen)
+{
+	u16			i;
+	arqSlot		*pSlot;
+	arqDest		*pDest;
+
+	for (i=0; i<ARQ_WINDOW; i++)
+	{
+		if (arqTx[i].uState == ARQ_FREE)
+			break;
+	}
+	if (i >= ARQ_WINDOW)
+		return (ARQ_BUSY);
+
+	pSlot = &arqTx[i];
+	pDest = ArqDestFind(uDest);
+	pDest->uUsed = ++uArqTxCount;
+
+	memset(pSlot, 0, sizeof(arqSlot));
+	uLen = Min(uLen, ARQ_PAYLOAD_LEN);
+	for (i=0; i<uLen; i++)
+	{
+		pSlot->upData[i] = upCmd[i] & 0x00FF;
+	}
+	pSlot->uDest = uDest;
+	pSlot->uSeq = pDest->uSeq;
+	pSlot->uState = ARQ_QUEUED;
+	pDest->uSeq = (pDest->uSeq + 1) & ARQ_SEQ_MASK;
+
+	return (pSlot->uSeq);
+}
+
+
+//==========================================================================================
+// Function:		ArqLow()
+//
+// Description: 	Returns the oldest sequence number still held for uDest, or the next
+//					one to be queued if nothing is held.  Frames are only sent while they
+//					are less than ARQ_WINDOW after it; the receiver ignores frames further
+//					ahead.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 ArqLow(u16 uDest)
+{
+	u16		i;
+	u16		uNext;
+	u16		uLow;
+
+	uNext = ArqDestFind(uDest)->uSeq;
+	uLow = uNext;
+	for (i=0; i<ARQ_WINDOW; i++)
+	{
+		if ( (arqTx[i].uState != ARQ_FREE) && (arqTx[i].uDest == uDest) &&
+			 (((uNext - arqTx[i].uSeq) & ARQ_SEQ_MASK) > ((uNext - uLow) & ARQ_SEQ_MASK)) )
+			uLow = arqTx[i].uSeq;
+	}
+	return (uLow);
+}
+
+
+//==========================================================================================
+// Function:		ArqService()
+//
+// Description: 	Called from MainLoop().  Executes the next buffered command in
+//					sequence, skipping frames the sender has given up on.  When the
+//					transmitter is free it sends a pending ack, a queued frame, or a
+//					frame whose ack timed out.  Acks go first so the sender's window
+//					keeps moving.
+//
+//					Returns the length of the frame put in txUserDataArray, or 0.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 ArqService(void)
+{
+	u16			i;
+	u16			n;
+	u16			uLow;
+	u16			*upTx;
+	arqPeer		*pPeer;
+	arqSlot		*pSlot;
+	u32			ulNow;
+
+	//---- execute received commands in sequence ---------------
+	if ( (uCommandActive == 0) && (uCommandPending == 0) )
+	{
+		for (i=0; i<ARQ_PEERS; i++)
+		{
+			pPeer = &arqRx[i];
+			n = (pPeer->uLow - pPeer->uBase) & ARQ_SEQ_MASK;
+			if ( ((pPeer->uMask & 1) == 0) && (n >= 1) && (n <= 2*ARQ_WINDOW) )
+			{
+				pPeer->uMask >>= 1;		// dropped by the sender
+				pPeer->uBase = (pPeer->uBase + 1) & ARQ_SEQ_MASK;
+				ulArqStats[ARQ_SKIPPED]++;
+			}
+			else if (pPeer->uMask & 1)
+			{
+				memset(upCommand, 0, COMMAND_PARMS*sizeof(u16));
+				memcpy(upCommand, pPeer->upBuf[pPeer->uBase % ARQ_WINDOW], ARQ_PAYLOAD_LEN*sizeof(u16));
+				pPeer->uMask >>= 1;
+				pPeer->uBase = (pPeer->uBase + 1) & ARQ_SEQ_MASK;
+				ulArqStats[ARQ_DELIVERED]++;
+
+				uCommandMulticast = False;
+				uCommandActive = 1;		// run it now, before another frame can
+				TaskCommand();			// overwrite upCommand
+				if (uTxMsgPending == True)
+					return (COMMAND_PARMS);	// the command sends a reply, as in MainLoop()
+				break;
+			}
+		}
+	}
+
+	if ( (uTxMsgPending == True) || (plcMode == TX_MODE) )
+		return (0);
+
+	upTx = txUserDataArray;
+
+	//---- ack --------------------------------------------
+	for (i=0; i<ARQ_PEERS; i++)
+	{
+		pPeer = &arqRx[i];
+		if (pPeer->uAckPending)
+		{
+			for (n=0; (n < ARQ_WINDOW) && (pPeer->uMask & (1<<n)); n++)
+				;						// frames held in sequence
+			*upTx++ = pPeer->uAddr >> 8;
+			*upTx++ = pPeer->uAddr & 0x00FF;
+			*upTx++ = CMD_ARQ_ACK;
+			*upTx++ = uMyAddress >> 8;
+			*upTx++ = uMyAddress & 0x00FF;
+			*upTx++ = (pPeer->uBase + n) & ARQ_SEQ_MASK;
+			*upTx++ = (pPeer->uMask >> (n+1)) & 0x00FF;
+			pPeer->uAckPending = False;
+			uTxMsgPending = True;
+			return (ARQ_ACK_LEN);
+		}
+	}
+
+	//---- data: first send, or resend after the timeout ----------
+	ulNow = CpuTimer0.InterruptCount;
+	for (i=0; i<ARQ_WINDOW; i++)
+	{
+		pSlot = &arqTx[i];
+		if (pSlot->uState == ARQ_SENT)
+		{
+			if ((ulNow - pSlot->ulSentAt) < pSlot->ulTimeout)
+				continue;
+
+			LinkResult(LinkFind(pSlot->uDest), False, 0);
+			if (pSlot->uTries > ARQ_RETRY_MAX)
+			{
+				pSlot->uState = ARQ_FREE;	// give up; the seq stays used
+				ulArqStats[ARQ_DROPPED]++;
+				continue;
+			}
+			ulArqStats[ARQ_RESENT]++;
+		}
+		else if (pSlot->uState != ARQ_QUEUED)
+		{
+			continue;
+		}
+
+		uLow = ArqLow(pSlot->uDest);
+		if (((pSlot->uSeq - uLow) & ARQ_SEQ_MASK) >= ARQ_WINDOW)
+			continue;
+
+		*upTx++ = pSlot->uDest >> 8;
+		*upTx++ = pSlot->uDest & 0x00FF;
+		*upTx++ = CMD_ARQ_DATA;
+		*upTx++ = uMyAddress >> 8;
+		*upTx++ = uMyAddress & 0x00FF;
+		*upTx++ = ArqDestFind(pSlot->uDest)->uEpoch;
+		*upTx++ = pSlot->uSeq;
+		*upTx++ = uLow;
+		memcpy(upTx, pSlot->upData, ARQ_PAYLOAD_LEN*sizeof(u16));
+
+		//---- the timeout doubles with each resend -----------
+		pSlot->ulTimeout = PLC_FRAME_TICKS(MAX_TX_MSG_LEN) + PLC_FRAME_TICKS(ARQ_ACK_LEN)
+						   + ARQ_HOLDOFF_TICKS + ARQ_MARGIN_TICKS;
+		pSlot->ulTimeout <<= Min(pSlot->uTries, 3);
+		pSlot->ulSentAt = ulNow;
+		pSlot->uTries++;
+		pSlot->uState = ARQ_SENT;
+
+		LinkFind(pSlot->uDest)->uSent++;
+		ulArqStats[ARQ_SENT_FRAMES]++;
+		uTxMsgPending = True;
+		return (MAX_TX_MSG_LEN);
+	}
+
+	return (0);
+}
+
+
+//==========================================================================================
+// Function:		CmdArqData()
+//
+// Description: 	CMD_ARQ_DATA frame from the power line (address bytes stripped):
+//						0	CMD_ARQ_DATA
+//						1-2	sender address
+//						3	epoch
+//						4	sequence number
+//						5	low, oldest sequence number the sender still holds
+//						6-	command
+//					Frames inside the receive window are buffered; ArqService() executes
+//					them in sequence.  Every frame is acked, including duplicates whose
+//					ack was lost.
+//
+//					Normally uBase is within ARQ_WINDOW of low: ahead of it when acks were
+//					lost, behind it while acked frames wait to be executed or when the
+//					sender dropped frames.  Anywhere else the receiver lost its state
+//					(reset, or its peer entry was reused) and restarts at low.  It also
+//					restarts at low when the epoch changes: the sender lost its state.
+//
+//					Frames sent to a group or broadcast address are ignored; only a
+//					single receiver can ack.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Restart on a new sender epoch.
+//==========================================================================================
+u16 CmdArqData(void)
+{
+	u16			i;
+	u16			uEpoch;
+	u16			uFrom;
+	u16			uSeq;
+	u16			uOffset;
+	u16			uLow;
+	arqPeer		*pPeer = 0;
+	arqPeer		*pOldest = &arqRx[0];
+
+	if (uCommandMulticast)
+	{
+		uCommandActive = 0;
+		return (SUCCESS);
+	}
+
+	uFrom = (upCommand[1] << 8) | upCommand[2];
+	uEpoch = upCommand[3] & ARQ_SEQ_MASK;
+	uSeq  = upCommand[4] & ARQ_SEQ_MASK;
+	uLow  = upCommand[5] & ARQ_SEQ_MASK;
+	uArqRxCount++;
+
+	//---- find the sender, or reuse the oldest entry -------
+	for (i=0; i<ARQ_PEERS; i++)
+	{
+		if (arqRx[i].uAddr == uFrom)
+			pPeer = &arqRx[i];
+		if ((u16)(uArqRxCount - arqRx[i].uUsed) > (u16)(uArqRxCount - pOldest->uUsed))
+			pOldest = &arqRx[i];
+	}
+	if (pPeer == 0)
+	{
+		pPeer = pOldest;
+		memset(pPeer, 0, sizeof(arqPeer));
+		pPeer->uAddr = uFrom;
+		pPeer->uEpoch = uEpoch;
+		pPeer->uBase = uLow;
+	}
+	pPeer->uUsed = uArqRxCount;
+
+	//---- restart on a new epoch or if the window is nowhere near the sender's ----
+	if ( (pPeer->uEpoch != uEpoch) ||
+		 ((((pPeer->uBase - uLow) & ARQ_SEQ_MASK) > ARQ_WINDOW) &&
+		  (((uLow - pPeer->uBase) & ARQ_SEQ_MASK) > 2*ARQ_WINDOW)) )
+	{
+		pPeer->uEpoch = uEpoch;
+		pPeer->uBase = uLow;
+		pPeer->uMask = 0;
+	}
+	pPeer->uLow = uLow;
+
+	uOffset = (uSeq - pPeer->uBase) & ARQ_SEQ_MASK;
+
+	if (uOffset < ARQ_WINDOW)
+	{
+		if ((pPeer->uMask & (1<<uOffset)) == 0)
+		{
+			memcpy(pPeer->upBuf[uSeq % ARQ_WINDOW], &upCommand[ARQ_HDR_LEN-2], ARQ_PAYLOAD_LEN*sizeof(u16));
+			pPeer->uMask |= 1<<uOffset;
+		}
+		else
+		{
+			ulArqStats[ARQ_DUPLICATES]++;
+		}
+	}
+	else
+	{
+		ulArqStats[ARQ_DUPLICATES]++;	// already executed, or too far ahead
+	}
+	pPeer->uAckPending = True;
+
+	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up.
+	return (SUCCESS);
+}
+
+
+//==========================================================================================
+// Function:		CmdArqAck()
+//
+// Description: 	CMD_ARQ_ACK frame from the power line (address bytes stripped):
+//						0	CMD_ARQ_ACK
+//						1-2	sender of the ack
+//						3	next sequence number the sender is missing
+//						4	mask: bit n = next + 1 + n received
+//					Frees the acked transmit slots and reports them to the link table.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdArqAck(void)
+{
+	u16			i;
+	u16			uFrom;
+	u16			uNext;
+	u16			uOffset;
+	u16			uBit;
+	arqSlot		*pSlot;
+	linkEntry	*pLink;
+
+	uFrom = (upCommand[1] << 8) | upCommand[2];
+	uNext = upCommand[3] & ARQ_SEQ_MASK;
+	pLink = LinkFind(uFrom);
+
+	for (i=0; i<ARQ_WINDOW; i++)
+	{
+		pSlot = &arqTx[i];
+		if ((pSlot->uState != ARQ_SENT) || (pSlot->uDest != uFrom))
+			continue;
+
+		uOffset = (uNext - pSlot->uSeq) & ARQ_SEQ_MASK;		// 1.. : before uNext
+		uBit = (pSlot->uSeq - uNext - 1) & ARQ_SEQ_MASK;		// position in the mask
+		if ( ((uOffset >= 1) && (uOffset <= 2*ARQ_WINDOW)) ||
+			 ((uBit < ARQ_WINDOW) && (upCommand[4] & (1 << uBit))) )
+		{
+			pSlot->uState = ARQ_FREE;
+			LinkResult(pLink, True, rxQuality.uSnr);
+			ulArqStats[ARQ_ACKED]++;
+		}
+	}
+
+	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up.
+	return (SUCCESS);
+}
@@ -0,0 +1,406 @@
+//==========================================================================================
+// Filename:		bench.c
+//
+// Description:		Host micro-benchmarks of the hot routines.
+//
+//					BenchRun() times each routine on the host build and reports, per
+//					routine: ns per call, calls per receive sample (how often the
+//					firmware runs it) and the share of one receive sample period
+//					(1/RX_Sampling) that makes.  The host is not the target, so the
+//					numbers are for comparing one build with the next, not cycle counts.
+//
+//					receive() is timed per uRxMode state: synthetic demod frames from
+//					FillTxBuffer() are fed in and each call is timed on its own and
+//					charged to the state it started in.  The other routines are timed
+//					in batches of BENCH_BATCH calls.
+//
+//					The results are printed and written as JSON.  Given the JSON of an
+//					earlier run, each routine is compared with it and the ones more than
+//					BENCH_REGRESS_PCT slower are flagged.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdio.h>						// fopen(), fprintf()
+#include <stdlib.h>						// rand(), malloc()
+#include <string.h>						// strstr()
+#ifdef _WIN32
+	#include <windows.h>				// QueryPerformanceCounter()
+#else
+	#include <time.h>					// clock_gettime()
+#endif
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	BENCH_BATCH			200000		// calls per batch timing
+#define	BENCH_FRAMES		200			// synthetic frames for receive()
+#define	BENCH_GAP			3000		// idle samples after each frame (> EOP hold off)
+#define	BENCH_DEMOD_LEVEL	3000		// demod level of a clean bit
+#define	BENCH_NOISE			300			// demod noise, peak
+#define	BENCH_REGRESS_PCT	10			// slower than the baseline by more than this = flagged
+#define	BENCH_MAX			16			// routines in one run
+
+#define	BENCH_SAMPLE_NS		(1.0e9 / RX_Sampling)
+#define	BENCH_FRAME_SAMPLES	((double)PLC_FRAME_BITS(MAX_TX_MSG_LEN) * TX_BIT_COUNT)
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	const char	*pName;
+	double		dNsPerOp;
+	double		dOpsPerSample;				// calls per receive sample in the firmware
+}	benchResult;
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static benchResult	benchRes[BENCH_MAX];
+static u16			uBenchCnt = 0;
+static volatile u16	uBenchSink;				// keeps results from being optimised away
+
+
+//==========================================================================================
+// Function:		BenchNow()
+//
+// Description: 	High resolution host time, ns.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double BenchNow(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER	liNow, liFreq;
+
+	QueryPerformanceCounter(&liNow);
+	QueryPerformanceFrequency(&liFreq);
+	return ((double)liNow.QuadPart * 1.0e9 / (double)liFreq.QuadPart);
+#else
+	struct timespec	tsNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return ((double)tsNow.tv_sec * 1.0e9 + (double)tsNow.tv_nsec);
+#endif
+}
+
+
+//==========================================================================================
+// Function:		BenchAdd()
+//
+// Description: 	Record one result.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void BenchAdd(const char *pName, double dNsPerOp, double dOpsPerSample)
+{
+	if (uBenchCnt >= BENCH_MAX)
+		return;
+	benchRes[uBenchCnt].pName = pName;
+	benchRes[uBenchCnt].dNsPerOp = dNsPerOp;
+	benchRes[uBenchCnt].dOpsPerSample = dOpsPerSample;
+	uBenchCnt++;
+}
+
+
+//==========================================================================================
+// Function:		BenchReceive()
+//
+// Description: 	Time receive() per uRxMode state on BENCH_FRAMES synthetic frames.
+//					Each frame is the bit string of FillTxBuffer() as a demod level of
+//					+-BENCH_DEMOD_LEVEL per bit plus noise, followed by BENCH_GAP samples
+//					of noise.  The cost of reading the clock is measured first and taken
+//					off every call.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void BenchReceive(void)
+{
+	static const char *cpStateName[5] = {"receive FIND_BITSYNC", "receive FIND_WORDSYNC",
+		"receive FIND_DATA", "receive FIND_EOP", "receive EOP_HOLD_OFF"};
+	double	dNs[5] = {0, 0, 0, 0, 0};
+	u32		ulCalls[5] = {0, 0, 0, 0, 0};
+	double	dT0, dT1, dClock;
+	u32		ulFrame, ulBit, n;
+	u16		uBits, uState, i;
+	s16		sLevel;
+
+	//---- cost of reading the clock -------------
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+		dT1 = BenchNow();
+	dClock = (dT1 - dT0) / BENCH_BATCH;
+
+	for (i=0; i<MAX_TX_MSG_LEN; i++)
+		txUserDataArray[i] = (i * 37 + 11) & 0xFF;
+	FillTxBuffer(MAX_TX_MSG_LEN);
+	uBits = uTxMsgLen;
+	SetPlcMode(RX_MODE);
+	reset_to_BitSync();
+
+	for (ulFrame=0; ulFrame<BENCH_FRAMES; ulFrame++)
+	{
+		for (ulBit=0; ulBit<(u32)uBits + BENCH_GAP/TX_BIT_COUNT; ulBit++)
+		{
+			if (ulBit < uBits)
+				sLevel = ((txDataArray[ulBit/16] >> (15 - (ulBit & 15))) & 1) ? BENCH_DEMOD_LEVEL : -BENCH_DEMOD_LEVEL;
+			else
+				sLevel = 0;
+			for (n=0; n<TX_BIT_COUNT; n++)
+			{
+				uState = uRxMode;
+				dT0 = BenchNow();
+				receive((s16)(sLevel + rand() % (2*BENCH_NOISE+1) - BENCH_NOISE));
+				dT1 = BenchNow();
+				if (uState < 5)
+				{
+					dNs[uState] += dT1 - dT0 - dClock;
+					ulCalls[uState]++;
+				}
+			}
+		}
+	}
+
+	for (i=0; i<5; i++)
+	{
+		if (ulCalls[i] > 0)
+			BenchAdd(cpStateName[i], dNs[i] / ulCalls[i], 1.0);
+	}
+}
+
+
+//==========================================================================================
+// Function:		BenchTaskRate()
+//
+// Description: 	Runs per receive sample of the MainLoop() task pfRun: 1/period of its
+//					schedTable[] entry, as registered by MainTasks().  0 if the task
+//					is not registered.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double BenchTaskRate(void (*pfRun)(void))
+{
+	u16		i;
+
+	for (i=0; i<uSchedTasks; i++)
+	{
+		if (schedTable[i].pfRun == pfRun)
+			return (1.0 / schedTable[i].uPeriod);
+	}
+	return (0.0);
+}
+
+
+//==========================================================================================
+// Function:		BenchBatches()
+//
+// Description: 	Time the other routines in batches of BENCH_BATCH calls.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			MainLoop() task rates from the scheduler table instead of a fixed
+//					one in 8 samples.
+//==========================================================================================
+static void BenchBatches(void)
+{
+	static u16	uUartWord = 0x1234;
+	u16			uAdc[OVERSAMPLE_RATE];
+	double		dT0;
+	u32			n;
+	u16			i;
+
+	//---- receive front end and demod, once per sample --------
+	for (i=0; i<OVERSAMPLE_RATE; i++)
+		uAdc[i] = 0x8000 + 1000*i;
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+	{
+		uAdc[n % OVERSAMPLE_RATE] += 7;
+		uBenchSink += AdcFrontEnd(uAdc);
+	}
+	BenchAdd("AdcFrontEnd", (BenchNow() - dT0) / BENCH_BATCH, 1.0);
+
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+		uBenchSink += RxDemod((s16)((n * 2731) & 0x3FFF) - 0x2000);
+	BenchAdd("RxDemod", (BenchNow() - dT0) / BENCH_BATCH, 1.0);
+
+	//---- transmit: once per frame, once per bit --------------
+	for (i=0; i<MAX_TX_MSG_LEN; i++)
+		txUserDataArray[i] = (i * 53 + 5) & 0xFF;
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH/100; n++)
+		uBenchSink += CalcCRC(TX_MODE, MAX_TX_MSG_LEN);
+	BenchAdd("CalcCRC", (BenchNow() - dT0) / (BENCH_BATCH/100), 1.0 / BENCH_FRAME_SAMPLES);
+
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH/100; n++)
+		FillTxBuffer(MAX_TX_MSG_LEN);
+	BenchAdd("FillTxBuffer", (BenchNow() - dT0) / (BENCH_BATCH/100), 1.0 / BENCH_FRAME_SAMPLES);
+
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+	{
+		if (uTxBitNum > uTxMsgLen)
+			uTxBitNum = 0;
+		ExtractNextTxBit();
+	}
+	BenchAdd("ExtractNextTxBit", (BenchNow() - dT0) / BENCH_BATCH, 1.0 / TX_BIT_COUNT);
+	SetPlcMode(RX_MODE);
+
+	//---- MainLoop tasks, at the period they are scheduled with -
+	MainTasks();
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+	{
+		WriteUART(1, &uUartWord);
+		HandleUART();
+	}
+	BenchAdd("WriteUART+HandleUART", (BenchNow() - dT0) / BENCH_BATCH, BenchTaskRate(TaskUart));
+
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+		HandleUART();
+	BenchAdd("HandleUART idle", (BenchNow() - dT0) / BENCH_BATCH, BenchTaskRate(TaskUart));
+
+	dT0 = BenchNow();
+	for (n=0; n<BENCH_BATCH; n++)
+	{
+		ubLampIntensityTarget = (n & 0x100) ? 255 : 0;
+		ControlLamp();
+	}
+	BenchAdd("ControlLamp", (BenchNow() - dT0) / BENCH_BATCH, BenchTaskRate(TaskLamp));
+}
+
+
+//==========================================================================================
+// Function:		BenchBaseline()
+//
+// Description: 	ns per call of routine pName in the JSON text pJson, 0 if not found.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double BenchBaseline(const char *pJson, const char *pName)
+{
+	char		cKey[80];
+	const char	*pPos;
+
+	sprintf(cKey, "\"name\": \"%.60s\"", pName);
+	pPos = strstr(pJson, cKey);
+	if (pPos == 0)
+		return (0);
+	pPos = strstr(pPos, "\"ns_per_op\":");
+	if (pPos == 0)
+		return (0);
+	return (atof(pPos + 12));
+}
+
+
+//==========================================================================================
+// Function:		BenchRun()
+//
+// Description: 	Run all benchmarks, print them, write them to pJsonFile (if not 0) and
+//					compare them with pBaselineFile (if not 0).  Returns the number of
+//					routines more than BENCH_REGRESS_PCT slower than the baseline.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 BenchRun(const char *pJsonFile, const char *pBaselineFile)
+{
+	FILE	*pF;
+	char	*pBase = 0;
+	long	lSize;
+	double	dBase, dPct;
+	u16		uRegress = 0;
+	u16		i;
+
+	uBenchCnt = 0;
+	BenchReceive();
+	BenchBatches();
+
+	//---- baseline -----------------------------------
+	if (pBaselineFile != 0)
+	{
+		pF = fopen(pBaselineFile, "r");
+		if (pF != 0)
+		{
+			fseek(pF, 0, SEEK_END);
+			lSize = ftell(pF);
+			fseek(pF, 0, SEEK_SET);
+			pBase = (char *)malloc(lSize + 1);
+			if (pBase != 0)
+				pBase[fread(pBase, 1, lSize, pF)] = 0;
+			fclose(pF);
+		}
+		if (pBase == 0)
+			mexPrintf("bench: cannot read baseline %s\n", pBaselineFile);
+	}
+
+	//---- print --------------------------------------
+	mexPrintf("%-24s %9s %10s %8s %9s\n", "routine", "ns/op", "ops/sample", "%sample", "vs base");
+	for (i=0; i<uBenchCnt; i++)
+	{
+		mexPrintf("%-24s %9.1f %10.4f %8.3f", benchRes[i].pName, benchRes[i].dNsPerOp,
+			benchRes[i].dOpsPerSample,
+			100.0 * benchRes[i].dNsPerOp * benchRes[i].dOpsPerSample / BENCH_SAMPLE_NS);
+		dBase = (pBase != 0) ? BenchBaseline(pBase, benchRes[i].pName) : 0;
+		if (dBase > 0)
+		{
+			dPct = 100.0 * (benchRes[i].dNsPerOp - dBase) / dBase;
+			mexPrintf(" %+8.1f%%", dPct);
+			if (dPct > BENCH_REGRESS_PCT)
+			{
+				mexPrintf("  REGRESSION");
+				uRegress++;
+			}
+		}
+		mexPrintf("\n");
+	}
+	mexPrintf("sample period %.0f ns; %d routines slower than the baseline by more than %d%%\n",
+		BENCH_SAMPLE_NS, uRegress, BENCH_REGRESS_PCT);
+	free(pBase);
+
+	//---- JSON ---------------------------------------
+	if (pJsonFile != 0)
+	{
+		pF = fopen(pJsonFile, "w");
+		if (pF == 0)
+		{
+			mexPrintf("bench: cannot write %s\n", pJsonFile);
+			return (uRegress);
+		}
+		fprintf(pF, "{\n  \"sample_period_ns\": %.1f,\n  \"results\": [\n", BENCH_SAMPLE_NS);
+		for (i=0; i<uBenchCnt; i++)
+		{
+			fprintf(pF, "    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"ops_per_sample\": %.6f, \"pct_sample\": %.4f}%s\n",
+				benchRes[i].pName, benchRes[i].dNsPerOp, benchRes[i].dOpsPerSample,
+				100.0 * benchRes[i].dNsPerOp * benchRes[i].dOpsPerSample / BENCH_SAMPLE_NS,
+				(i + 1 < uBenchCnt) ? "," : "");
+		}
+		fprintf(pF, "  ]\n}\n");
+		fclose(pF);
+	}
+
+	return (uRegress);
+}
+
+#endif	// MEX_COMPILE
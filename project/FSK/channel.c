@@ -0,0 +1,328 @@
+//==========================================================================================
+// Filename:		channel.c
+//
+// Description:		Host power line channel model.
+//
+//					ChanSample() takes one clean receive sample (ADC counts at
+//					RX_Sampling) and returns it as the modem would see it after the line:
+//
+//					- Frequency selective attenuation: a flat gain plus up to
+//					  CHAN_MAX_PATHS echoes (delay in samples, gain).  The receiver
+//					  samples the 60 - 75 kHz band aliased (see scan.c), and an echo of a
+//					  whole number of samples has the same phase at f and f - RX_Sampling,
+//					  so the echoes give the same notches as on the real band.
+//					- Cyclostationary background noise: Gaussian, with a power that
+//					  rises by dCycloDepth at the peaks of the mains, |sin|^uCycloExp.
+//					- Mains synchronous impulses: one burst per mains half cycle at
+//					  dSyncPhase (dimmers, rectifiers).
+//					- Asynchronous impulsive bursts: Poisson arrivals, exponential length.
+//					- Recorded noise: a noise-only section cut from a field capture,
+//					  played back in a loop (ChanLoadNoise()).
+//
+//					Set chanCfg (or ChanPreset()), call ChanReset(), and every host
+//					receiver run through processReadSamples() passes its samples through
+//					the model while chanCfg.uEnable is True.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdio.h>						// fopen(), fscanf()
+#include <stdlib.h>						// rand(), malloc()
+#include <string.h>						// contains memset()
+#include <math.h>						// sqrt(), log(), sin(), cos()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	CHAN_PI				3.14159265358979
+#define	CHAN_MAINS_HZ		60
+#define	CHAN_HALF_CYCLE		(RX_Sampling/(2*CHAN_MAINS_HZ))		// samples
+#define	CHAN_HIST_LEN		64			// longest echo delay + 1, power of 2
+#define	CHAN_REC_MAX		(1L << 20)	// longest recorded noise section (samples)
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+chanModel	chanCfg;					// channel model used by processReadSamples()
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static double	dChanHist[CHAN_HIST_LEN];	// clean samples for the echoes
+static u16		uChanHistIdx = 0;
+static u32		ulChanSample = 0;			// samples since ChanReset(), sets the mains phase
+static u32		ulChanBurstLeft = 0;		// samples left in the asynchronous burst
+static s16		*spChanRec = 0;				// recorded noise
+static u32		ulChanRecLen = 0;
+static u32		ulChanRecIdx = 0;
+
+
+//==========================================================================================
+// Function:		ChanGauss()
+//
+// Description: 	Unit variance Gaussian sample (Box-Muller).
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double ChanGauss(void)
+{
+	double	dU1, dU2;
+
+	dU1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+	dU2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+	return (sqrt(-2.0 * log(dU1)) * cos(2.0 * CHAN_PI * dU2));
+}
+
+
+//==========================================================================================
+// Function:		ChanPreset()
+//
+// Description: 	Fill chanCfg with one of the CHAN_xxx models.  The levels are ADC
+//					counts for a receive signal of about 8000 counts peak; scale them
+//					with dGain or the noise fields for other levels.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ChanPreset(u16 uModel)
+{
+	memset(&chanCfg, 0, sizeof(chanCfg));
+	chanCfg.uEnable = True;
+	chanCfg.dGain = 1.0;
+	chanCfg.uCycloExp = 2;
+
+	switch (uModel)
+	{
+		case CHAN_AWGN:
+		{
+			chanCfg.dNoiseRms = 400.0;
+			break;
+		}
+
+		case CHAN_RESIDENTIAL:				// short branches, light loads
+		{
+			chanCfg.dGain = 0.5;
+			chanCfg.uPaths = 2;
+			chanCfg.uPathDelay[0] = 3;	chanCfg.dPathGain[0] = -0.3;
+			chanCfg.uPathDelay[1] = 7;	chanCfg.dPathGain[1] = 0.15;
+			chanCfg.dNoiseRms = 150.0;
+			chanCfg.dCycloDepth = 3.0;
+			chanCfg.dSyncRms = 1500.0;
+			chanCfg.dSyncPhase = 0.1;
+			chanCfg.dSyncLenMs = 0.3;
+			chanCfg.dImpRate = 5.0;
+			chanCfg.dImpLenMs = 0.2;
+			chanCfg.dImpRms = 2000.0;
+			break;
+		}
+
+		case CHAN_INDUSTRIAL:				// long runs, drives and welders
+		{
+			chanCfg.dGain = 0.2;
+			chanCfg.uPaths = 4;
+			chanCfg.uPathDelay[0] = 2;	chanCfg.dPathGain[0] = -0.5;
+			chanCfg.uPathDelay[1] = 5;	chanCfg.dPathGain[1] = 0.3;
+			chanCfg.uPathDelay[2] = 11;	chanCfg.dPathGain[2] = -0.2;
+			chanCfg.uPathDelay[3] = 23;	chanCfg.dPathGain[3] = 0.1;
+			chanCfg.dNoiseRms = 200.0;
+			chanCfg.dCycloDepth = 8.0;
+			chanCfg.uCycloExp = 6;
+			chanCfg.dSyncRms = 3000.0;
+			chanCfg.dSyncPhase = 0.45;
+			chanCfg.dSyncLenMs = 0.8;
+			chanCfg.dImpRate = 30.0;
+			chanCfg.dImpLenMs = 0.5;
+			chanCfg.dImpRms = 4000.0;
+			break;
+		}
+
+		case CHAN_OFFICE:					// lighting ballasts and switch mode supplies
+		default:
+		{
+			chanCfg.dGain = 0.35;
+			chanCfg.uPaths = 3;
+			chanCfg.uPathDelay[0] = 2;	chanCfg.dPathGain[0] = 0.4;
+			chanCfg.uPathDelay[1] = 9;	chanCfg.dPathGain[1] = -0.25;
+			chanCfg.uPathDelay[2] = 15;	chanCfg.dPathGain[2] = 0.1;
+			chanCfg.dNoiseRms = 250.0;
+			chanCfg.dCycloDepth = 4.0;
+			chanCfg.uCycloExp = 4;
+			chanCfg.dSyncRms = 2000.0;
+			chanCfg.dSyncPhase = 0.25;
+			chanCfg.dSyncLenMs = 0.5;
+			chanCfg.dImpRate = 10.0;
+			chanCfg.dImpLenMs = 0.3;
+			chanCfg.dImpRms = 2500.0;
+			break;
+		}
+	}
+}
+
+
+//==========================================================================================
+// Function:		ChanReset()
+//
+// Description: 	Clear the echo history, the mains phase, the burst state and the
+//					playback position.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ChanReset(void)
+{
+	memset(dChanHist, 0, sizeof(dChanHist));
+	uChanHistIdx = 0;
+	ulChanSample = 0;
+	ulChanBurstLeft = 0;
+	ulChanRecIdx = 0;
+}
+
+
+//==========================================================================================
+// Function:		ChanLoadNoise()
+//
+// Description: 	Load a noise-only section of a field capture for playback: a text
+//					file with one ADC sample per line.  Playback is scaled by
+//					chanCfg.dRecGain and loops over the section.  Returns the number of
+//					samples loaded, 0 if the file could not be read.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u32 ChanLoadNoise(const char *pFile)
+{
+	FILE	*pF;
+	int		iSample;
+
+	if (spChanRec == 0)
+		spChanRec = (s16 *)malloc(CHAN_REC_MAX * sizeof(s16));
+	ulChanRecLen = 0;
+	ulChanRecIdx = 0;
+	if (spChanRec == 0)
+		return (0);
+
+	pF = fopen(pFile, "r");
+	if (pF == 0)
+		return (0);
+	while ((ulChanRecLen < CHAN_REC_MAX) && (fscanf(pF, "%d", &iSample) == 1))
+		spChanRec[ulChanRecLen++] = (s16)iSample;
+	fclose(pF);
+
+	return (ulChanRecLen);
+}
+
+
+//==========================================================================================
+// Function:		ChanSample()
+//
+// Description: 	Pass one clean receive sample through the channel in chanCfg.
+//					The result is clipped to the s16 range like the ADC front end.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+s16 ChanSample(s16 sClean)
+{
+	double	dOut;
+	double	dPhase;
+	double	dRms;
+	u32		ulHalf;
+	u16		i;
+
+	//---- frequency selective attenuation ---------------
+	uChanHistIdx = (uChanHistIdx + 1) & (CHAN_HIST_LEN-1);
+	dChanHist[uChanHistIdx] = sClean;
+	dOut = sClean;
+	for (i=0; i<chanCfg.uPaths; i++)
+		dOut += chanCfg.dPathGain[i] * dChanHist[(uChanHistIdx - chanCfg.uPathDelay[i]) & (CHAN_HIST_LEN-1)];
+	dOut *= chanCfg.dGain;
+
+	//---- cyclostationary background noise ---------------
+	ulHalf = (u32)CHAN_HALF_CYCLE;
+	dPhase = (double)(ulChanSample % ulHalf) / ulHalf;		// 0..1 of the half cycle
+	dRms = chanCfg.dNoiseRms * sqrt(1.0 + chanCfg.dCycloDepth * pow(sin(CHAN_PI * dPhase), chanCfg.uCycloExp));
+	dOut += dRms * ChanGauss();
+
+	//---- mains synchronous impulses ---------------------
+	if ((chanCfg.dSyncRms > 0) &&
+		(dPhase >= chanCfg.dSyncPhase) &&
+		(dPhase < chanCfg.dSyncPhase + chanCfg.dSyncLenMs * CHAN_MAINS_HZ * 2 / 1000.0))
+	{
+		dOut += chanCfg.dSyncRms * ChanGauss();
+	}
+
+	//---- asynchronous impulsive bursts ------------------
+	if (ulChanBurstLeft == 0)
+	{
+		if ((chanCfg.dImpRate > 0) && (rand() < chanCfg.dImpRate / RX_Sampling * RAND_MAX))
+		{
+			ulChanBurstLeft = 1 + (u32)(-log((rand() + 1.0) / (RAND_MAX + 1.0))
+							  * chanCfg.dImpLenMs * RX_Sampling / 1000.0);
+		}
+	}
+	if (ulChanBurstLeft > 0)
+	{
+		ulChanBurstLeft--;
+		dOut += chanCfg.dImpRms * ChanGauss();
+	}
+
+	//---- recorded field noise ---------------------------
+	if ((chanCfg.dRecGain > 0) && (ulChanRecLen > 0))
+	{
+		dOut += chanCfg.dRecGain * spChanRec[ulChanRecIdx];
+		if (++ulChanRecIdx >= ulChanRecLen)
+			ulChanRecIdx = 0;
+	}
+
+	ulChanSample++;
+
+	if (dOut > 32767.0)
+		dOut = 32767.0;
+	if (dOut < -32768.0)
+		dOut = -32768.0;
+	return ((s16)dOut);
+}
+
+
+//==========================================================================================
+// Function:		ChanResponse()
+//
+// Description: 	Print the gain (dB) of the echo model from 60 to 75 kHz in 1 kHz steps.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ChanResponse(void)
+{
+	double	dRe, dIm, dW;
+	u16		uKhz, i;
+
+	for (uKhz=60; uKhz<=75; uKhz++)
+	{
+		dW = 2.0 * CHAN_PI * uKhz * 1000.0 / RX_Sampling;
+		dRe = 1.0;
+		dIm = 0.0;
+		for (i=0; i<chanCfg.uPaths; i++)
+		{
+			dRe += chanCfg.dPathGain[i] * cos(dW * chanCfg.uPathDelay[i]);
+			dIm -= chanCfg.dPathGain[i] * sin(dW * chanCfg.uPathDelay[i]);
+		}
+		mexPrintf("%2d kHz %6.1f dB\n", uKhz,
+			10.0 * log10(chanCfg.dGain * chanCfg.dGain * (dRe*dRe + dIm*dIm) + 1e-12));
+	}
+}
+
+#endif	// MEX_COMPILE
@@ -26,9 +26,20 @@
 u16 CmdReadMemory(void);
 u16 CmdWriteMemory(void);
 u16 CmdReadStats(void);
+u16 CmdReadZcStats(void);
+u16 CmdScan(void);
+u16 CmdReadLinks(void);
+u16 CmdPLCReliable(void);
+u16 CmdArqStatus(void);
+u16 CmdPLCRelayed(void);
+u16 CmdRelayStatus(void);
+u16 CmdKernelCheck(void);
+u16 CmdLoadStats(void);
+u16 CmdBootTimes(void);
 u16 CmdConfigFlooder(void);
 u16 CmdPLCCommand(void);
 u16 CmdLamp(void);
+u16 CmdLampBatch(void);
 //u16 CmdConfigCorrupter(void);
 u16 CmdLocalAddress(void);
 u16 CmdPLCEchoSet(void);
@@ -67,6 +78,16 @@ u16	uLampIgniteState = 0;
 // 09/17/04	HEM		New command CmdPlcCommand().
 // 09/22/04	HEM		New command CmdLamp.
 // 11/17/04	HEM		Removed trace trigger code.
+// 19Oct26			New command CmdReadZcStats().
+// 19Oct26			New command CmdScan().
+// 19Oct26			New command CmdReadLinks().
+// 19Oct26			Reliable delivery commands.
+// 19Oct26			New command CmdLampBatch().
+// 19Oct26			Clear uCommandMulticast when a command finishes.
+// 19Oct26			Repeater commands.
+// 19Oct26			New command CmdKernelCheck().
+// 19Oct26			New command CmdLoadStats().
+// 19Oct26			New command CmdBootTimes().
 //==========================================================================================
 void TaskCommand(void)
 {
@@ -81,6 +102,7 @@ void TaskCommand(void)
 			upCommand[i] = upSerialCommand[i];
 		}
 		uCommandPending = 0;
+		uCommandMulticast = False;
 	}
 
 	switch (upCommand[NUMBER])
@@ -97,11 +119,63 @@ void TaskCommand(void)
 		CmdReadStats();
 		break;
 
+	case CMD_READ_ZC_STATS:
+		CmdReadZcStats();
+		break;
+
+	case CMD_SCAN:
+		CmdScan();
+		break;
+
+	case CMD_READ_LINKS:
+		CmdReadLinks();
+		break;
+
+	case CMD_PLC_RELIABLE:
+		CmdPLCReliable();
+		break;
+
+	case CMD_ARQ_STATUS:
+		CmdArqStatus();
+		break;
+
+	case CMD_ARQ_DATA:
+		CmdArqData();
+		break;
+
+	case CMD_ARQ_ACK:
+		CmdArqAck();
+		break;
+
+	case CMD_PLC_RELAYED:
+		CmdPLCRelayed();
+		break;
+
+	case CMD_RELAY_STATUS:
+		CmdRelayStatus();
+		break;
+
+	case CMD_KERNEL_CHECK:
+		CmdKernelCheck();
+		break;
+
+	case CMD_LOAD_STATS:
+		CmdLoadStats();
+		break;
+
+	case CMD_BOOT_TIMES:
+		CmdBootTimes();
+		break;
+
 	case CMD_LAMP_DIRECT:
 	case CMD_LAMP:
 		CmdLamp();
 		break;
 
+	case CMD_LAMP_BATCH:
+		CmdLampBatch();
+		break;
+
 	case CMD_PLC_COMMAND:
 		CmdPLCCommand();		
 		break;
@@ -140,6 +214,8 @@ void TaskCommand(void)
 	// Command LED (if present), and do anything else which turns out to be useful.
 	if (uCommandActive == 0)
 	{
+		uCommandMulticast = False;
+
 		#if (TRACE_BUF_LEN > 0)	
 		// Reset the trace buffer triggered bit, if it was set to stop at command complete.
 		// The second condition, prevents the end of "CMD_DIAG_TRACE_CONFIG" from disabling
@@ -275,6 +351,11 @@ Description: 	DSP Command "Read Status"
 				 	0	 return code
 				 	1	 count
 				 	2-N	 statistics data	
+				 	N+1	 sRxDemodBias, demod DC bias at the last preamble
+				 	N+2	 sRxFreqOffset, carrier offset (Hz) at the last preamble
+				 	N+3	 rxQuality, link quality of the last packet (5 words)
+				 	N+8	 ulRxQualHist[4][QUAL_HIST_BINS]: RSSI, SNR, timing error,
+				 		 parity errors (see RxQualityLatch())
 
 				Data is returned via the WriteUART() and WriteUARTValue() funtions.
 				NOTE: As a Cmd* function, this should only be called as the result of a
@@ -283,6 +364,8 @@ Description: 	DSP Command "Read Status"
 
 Revision History:
 17Feb05	 Hagen		Made from CmdReadMemory()
+19Oct26				Append the receiver's carrier offset estimate
+19Oct26				Append the link quality of the last packet and its histograms
 ==========================================================================================*/
 u16 CmdReadStats(void)
 {
@@ -291,15 +374,168 @@ u16 CmdReadStats(void)
 	{
 		memset( (u16*)ulPlcStats, 0, PLC_STATS_LEN*sizeof(u16) );
 		memset( (u16*)ulBerStats, 0, BER_STATS_LEN*sizeof(u16) );
+		memset( (u16*)ulRxQualHist, 0, sizeof(ulRxQualHist) );
 		WriteUARTValue( SUCCESS );
 	}
 	else
 	{
 		// For serial commands the return code has to be sent before the data.
 		WriteUARTValue( SUCCESS );
-		WriteUARTValue( PLC_STATS_LEN + BER_STATS_LEN );
+		WriteUARTValue( PLC_STATS_LEN + BER_STATS_LEN + 2 + sizeof(rxQuality) + QUAL_HIST_LEN );
 		WriteUART( PLC_STATS_LEN, (u16*)ulPlcStats );
 		WriteUART( BER_STATS_LEN, (u16*)ulBerStats );
+		WriteUARTValue( (u16)sRxDemodBias );
+		WriteUARTValue( (u16)sRxFreqOffset );
+		WriteUART( sizeof(rxQuality), (u16*)&rxQuality );
+		WriteUART( QUAL_HIST_LEN, (u16*)ulRxQualHist );
+	}
+	
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+/*==========================================================================================
+Function:		CmdReadZcStats()
+Description: 	DSP Command "Read Mains Phase Statistics"
+				Parm #	Description
+					0	Command number = 0011h
+					1	reset flag
+						1 ==  reset mains phase counters
+						else  read mains phase counters
+
+				returned values
+				 	word description
+				 	0	 return code
+				 	1	 count
+				 	2	 uZcPeriod, samples per mains cycle (0 = no mains sync)
+				 	3	 uZcTxBin, first phase bin of the transmit window
+				 	4-N	 ulZcNoise[ZC_PHASE_BINS], ulZcStats[ZC_PHASE_BINS][2]	
+
+				Data is returned via the WriteUART() and WriteUARTValue() funtions.
+
+Revision History:
+19Oct26				Made from CmdReadStats()
+==========================================================================================*/
+u16 CmdReadZcStats(void)
+{
+
+	if( upCommand[1] == 1 ) 
+	{
+		memset( (u16*)ulZcNoise, 0, sizeof(ulZcNoise) );
+		memset( (u16*)ulZcStats, 0, sizeof(ulZcStats) );
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( 2 + ZC_STATS_LEN );
+		WriteUARTValue( uZcPeriod );
+		WriteUARTValue( uZcTxBin );
+		WriteUART( sizeof(ulZcNoise), (u16*)ulZcNoise );
+		WriteUART( sizeof(ulZcStats), (u16*)ulZcStats );
+	}
+	
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+/*==========================================================================================
+Function:		CmdReadLinks()
+Description: 	DSP Command "Read Link Table"
+				Parm #	Description
+					0	Command number = 0013h
+					1	reset flag
+						1 ==  empty the link table
+						else  read the link table
+
+				returned values
+				 	word description
+				 	0	 return code
+				 	1	 count
+				 	2-N	 linkTable[LINK_TABLE_LEN], see linkEntry in main.h
+
+				Data is returned via the WriteUART() and WriteUARTValue() funtions.
+
+Revision History:
+19Oct26				Made from CmdReadZcStats()
+==========================================================================================*/
+u16 CmdReadLinks(void)
+{
+
+	if( upCommand[1] == 1 ) 
+	{
+		LinkInit();
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( sizeof(linkTable) );
+		WriteUART( sizeof(linkTable), (u16*)linkTable );
+	}
+	
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+/*==========================================================================================
+Function:		CmdScan()
+Description: 	DSP Command "Line Spectrum Scan"
+				Parm #	Description
+					0	Command number = 0012h
+					1	start flag
+						1 ==  start a scan of parm 2 blocks
+						else  read the scan results
+					2	number of 128 sample blocks to sum (1..SCAN_MAX_BLOCKS)
+
+				returned values
+				 	word description
+				 	0	 return code
+				 	1	 count
+				 	2	 uScanActive, 1 = scan still running
+				 	3	 uScanBlocksDone, blocks summed so far
+				 	4-N	 per bin: frequency (10 Hz units), power (u32)
+
+				The scan only runs while the receiver is idle; blocks interrupted by
+				a packet are discarded.  Power is relative (ADC counts squared, scaled).
+
+				Data is returned via the WriteUART() and WriteUARTValue() funtions.
+
+Revision History:
+19Oct26				New command.
+==========================================================================================*/
+u16 CmdScan(void)
+{
+	u16		i;
+
+	if( upCommand[1] == 1 ) 
+	{
+		ScanStart( upCommand[2] );
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( 2 + SCAN_BINS*3 );
+		WriteUARTValue( uScanActive );
+		WriteUARTValue( uScanBlocksDone );
+		for( i=0; i<SCAN_BINS; i++ )
+		{
+			WriteUARTValue( uScanFreq[i] );
+			WriteUART( sizeof(ulScanPower[i]), (u16*)&ulScanPower[i] );
+		}
 	}
 	
 	// Command is done.  Allow TaskCommand to finish up.
@@ -430,6 +666,276 @@ u16 CmdPLCCommand(void)
 }
 
 
+//==========================================================================================
+// Function:		CmdPLCReliable()
+//
+// Description: 	Like CmdPLCCommand(), but the command is delivered with acks and
+//					resends (arq.c).  Returns at once; several commands may be queued
+//					before the first is acked.
+//					Parm #	Description
+//						0	Command number = 0014h
+//						1	destination address high byte
+//						2	destination address low byte
+//					 3-31	command to run at the destination, one byte per word
+//
+//					Returns SUCCESS and the sequence number, or ERR_ARQ_BUSY if
+//					ARQ_WINDOW commands are already waiting for their acks.
+//
+// Revision History:
+// 19Oct26			New function, copied from CmdPLCCommand().
+//==========================================================================================
+u16 CmdPLCReliable(void)
+{
+	u16	uStatus = SUCCESS;		// Return value.
+	u16	uSeq;					// sequence number of the queued frame
+
+	uSeq = ArqQueue( ((upCommand[1] & 0x00FF) << 8) | (upCommand[2] & 0x00FF),
+					 &upCommand[3], COMMAND_PARMS-3 );
+	if (uSeq == ARQ_BUSY)
+	{
+		uStatus = ERR_ARQ_BUSY;
+		WriteUARTValue(uStatus);
+	}
+	else
+	{
+		WriteUARTValue(uStatus);
+		WriteUARTValue(uSeq);
+	}
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return (uStatus);
+}
+
+
+//==========================================================================================
+// Function:		CmdArqStatus()
+//
+// Description: 	Read or clear the reliable delivery statistics.
+//					Parm #	Description
+//						0	Command number = 0015h
+//						1	reset flag
+//							1 ==  clear ulArqStats[]
+//							else  read ulArqStats[] (see main.h)
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdArqStatus(void)
+{
+
+	if( upCommand[1] == 1 ) 
+	{
+		memset( (u16*)ulArqStats, 0, sizeof(ulArqStats) );
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( ARQ_STATS_LEN );
+		WriteUART( ARQ_STATS_LEN, (u16*)ulArqStats );
+	}
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+//==========================================================================================
+// Function:		CmdPLCRelayed()
+//
+// Description: 	Like CmdPLCCommand(), but the command is repeated by other nodes
+//					until it reaches a destination out of direct reach (relay.c).
+//					Parm #	Description
+//						0	Command number = 0016h
+//						1	destination address high byte (node, group or broadcast)
+//						2	destination address low byte
+//						3	hop limit, repeats allowed on the way (0 = direct only)
+//					 4-31	command to run at the destination, one byte per word
+//
+//					Returns SUCCESS and the sequence number, or ERR_RELAY_BUSY if the
+//					last relay frame has not been sent yet.
+//
+// Revision History:
+// 19Oct26			New function, copied from CmdPLCReliable().
+//==========================================================================================
+u16 CmdPLCRelayed(void)
+{
+	u16	uStatus = SUCCESS;		// Return value.
+	u16	uSeq;					// sequence number of the frame
+
+	uSeq = RelaySend( ((upCommand[1] & 0x00FF) << 8) | (upCommand[2] & 0x00FF),
+					  upCommand[3], &upCommand[4], COMMAND_PARMS-4 );
+	if (uSeq == RELAY_BUSY)
+	{
+		uStatus = ERR_RELAY_BUSY;
+		WriteUARTValue(uStatus);
+	}
+	else
+	{
+		WriteUARTValue(uStatus);
+		WriteUARTValue(uSeq);
+	}
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return (uStatus);
+}
+
+
+//==========================================================================================
+// Function:		CmdRelayStatus()
+//
+// Description: 	Read or clear the repeater statistics.
+//					Parm #	Description
+//						0	Command number = 0017h
+//						1	reset flag
+//							1 ==  clear ulRelayStats[]
+//							else  read ulRelayStats[] (see main.h)
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdRelayStatus(void)
+{
+
+	if( upCommand[1] == 1 ) 
+	{
+		memset( (u16*)ulRelayStats, 0, sizeof(ulRelayStats) );
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( RELAY_STATS_LEN );
+		WriteUART( RELAY_STATS_LEN, (u16*)ulRelayStats );
+	}
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+//==========================================================================================
+// Function:		CmdKernelCheck()
+//
+// Description: 	Cross-check the assembly and intrinsic kernels against their C
+//					reference and time them (see KernelCheck() in kernels.c).
+//					Parm #	Description
+//						0	Command number = 0018h
+//					Reply: SUCCESS, KERNEL_CHECK_LEN, results.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdKernelCheck(void)
+{
+	static u16	upResult[KERNEL_CHECK_LEN];		// sent after this function returns
+
+	KernelCheck(upResult);
+
+	// For serial commands the return code has to be sent before the data.
+	WriteUARTValue( SUCCESS );
+	WriteUARTValue( KERNEL_CHECK_LEN );
+	WriteUART( KERNEL_CHECK_LEN, upResult );
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+//==========================================================================================
+// Function:		CmdLoadStats()
+//
+// Description: 	Read or clear the CPU load statistics (load.c).
+//					Parm #	Description
+//						0	Command number = 0019h
+//						1	reset flag
+//							1 ==  clear the statistics
+//							else  read them
+//					Reply: SUCCESS, LOAD_STATS_LEN, seconds measured, longest adc_isr()
+//					run (cycles), then last, min, avg, max load (0.1 % units) for each
+//					of the LOAD_BUCKETS buckets: adc_isr(), IDLE, rest of the loop and
+//					the scheduler tasks in schedTable[] order.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdLoadStats(void)
+{
+	static u16	upReply[2];					// sent after this function returns
+
+	if( upCommand[1] == 1 ) 
+	{
+		LoadReset();
+		WriteUARTValue( SUCCESS );
+	}
+	else
+	{
+		upReply[0] = uLoadSeconds;
+		upReply[1] = uLoadIsrMax;
+
+		// For serial commands the return code has to be sent before the data.
+		WriteUARTValue( SUCCESS );
+		WriteUARTValue( LOAD_STATS_LEN );
+		WriteUART( 2, upReply );
+		WriteUART( LOAD_BUCKETS*LOAD_STAT_WORDS, (u16*)uLoadStats );
+	}
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
+//==========================================================================================
+// Function:		CmdBootTimes()
+//
+// Description: 	Report how long each phase of main() took at the last boot.
+//					Parm #	Description
+//						0	Command number = 001Ah
+//					Reply: SUCCESS, BOOT_TIMES_LEN, then the time of each of the
+//					BOOT_PHASES phases in microseconds, 32 bits each (low word first),
+//					from InitSysCtrl() to the start of MainLoop().
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdBootTimes(void)
+{
+	static u32	ulReply[BOOT_PHASES];		// sent after this function returns
+	u32			ulStart = 0;				// CYCLE_COUNT() is 0 when LoadInit() starts it
+	u16			i;
+
+	for (i=0; i<BOOT_PHASES; i++)
+	{
+		ulReply[i] = (ulBootStamp[i] - ulStart) / (DSP_FREQ / 1000000L);
+		ulStart = ulBootStamp[i];
+	}
+
+	// For serial commands the return code has to be sent before the data.
+	WriteUARTValue( SUCCESS );
+	WriteUARTValue( BOOT_TIMES_LEN );
+	WriteUART( BOOT_TIMES_LEN, (u16*)ulReply );
+
+	// Command is done.  Allow TaskCommand to finish up.
+	uCommandActive = 0;
+
+	return ( SUCCESS );
+}
+
+
 //==========================================================================================
 // Function:		CmdConfigFlooder()
 //
@@ -559,6 +1065,7 @@ u16 CmdPLCEchoSet(void)
 //
 // Revision History:
 // 01/17/05 Hagen	New function
+// 19Oct26			No echo to a group or broadcast frame.
 //==========================================================================================
 u16 CmdPLCEcho(void)
 {
@@ -574,7 +1081,8 @@ u16 CmdPLCEcho(void)
 	*txUserData++ = uMyAddress& 0x00FF;
 	*txUserData++ = uStatus;				// return code
 	
-	uTxMsgPending = True;	// Set flag to tell main loop to start sending message when traffic permits
+	if (!uCommandMulticast)		// every member answering at once would collide
+		uTxMsgPending = True;	// Set flag to tell main loop to start sending message when traffic permits
 	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up.
 	ulBerStats[BER_ECHO_COUNT]++;				// Add more here!!!
 
@@ -606,6 +1114,7 @@ u16 CmdPLCEcho(void)
 //
 // Revision History:
 // 01/17/05 Hagen	New function
+// 19Oct26			Report the result to the link table.
 //==========================================================================================
 u16 CmdPLCEchoAck(void)
 {
@@ -622,6 +1131,10 @@ u16 CmdPLCEchoAck(void)
 			ulBerStats[BER_ACK_COUNT]++;				// Add more here!!!
 		else
 			ulBerStats[BER_NZERO_COUNT]++;				// Add more here!!!
+
+		#if LINK_ADAPT == True
+		LinkAck( uFromAddress, (upCommand[3] == 0) );
+		#endif
 	}
 	
 	
@@ -680,6 +1193,7 @@ void InitLampVars(void)
 //
 // Revision History:
 // 09/23/04 HEM		New function.
+// 19Oct26			Lamp commands moved to LampControl().
 //==========================================================================================
 enum {	LAMP_OFF,				// 0 
 		LAMP_UP,				// 1
@@ -785,11 +1299,35 @@ u16 ubFadeStepTable[16]=	{	101,
 u16	CmdLamp(void)
 {
 	u16	uStatus = SUCCESS;		// Return value.
+
+	LampControl(upCommand[0], upCommand[1]);
+
+	WriteUARTValue(uStatus);	// Respond status to UART
+	
+	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up. 
+		
+	return (uStatus);		
+}
+
+
+//==========================================================================================
+// Function:		LampControl()
+//
+// Description: 	Carries out one lamp command for CmdLamp() or LampBatch().
+//						uCmdNum	CMD_LAMP_DIRECT: uValue is the lamp intensity
+//								CMD_LAMP:		 uValue is the LAMP command
+//
+// Revision History:
+// 19Oct26			Split out of CmdLamp().
+// 19Oct26			LAMP_REMOVE_FROM_GROUPn cleared every group.
+//==========================================================================================
+void LampControl(u16 uCmdNum, u16 uValue)
+{
 	u16	uLampCmd;
 	
-		if (upCommand[0] == CMD_LAMP_DIRECT)
+		if (uCmdNum == CMD_LAMP_DIRECT)
 		{
-			if (upCommand[1] == 0)				// Dim down to MinLevel, then shut off
+			if (uValue == 0)				// Dim down to MinLevel, then shut off
 			{
 				ubLampIntensityTarget = 0;		
 				if(ubLampIntensity != ubLampMinLevel)
@@ -801,13 +1339,13 @@ u16	CmdLamp(void)
 					uFadeInterval = 0;
 				}
 			}
-			else if (upCommand[1] == 255)		// Cease any dimming in progress and hold at present level
+			else if (uValue == 255)		// Cease any dimming in progress and hold at present level
 			{	
 				ubLampIntensityTarget = ubLampIntensity;
 			}
 			else								// Dim to new level
 			{
-				ubLampIntensityTarget = Saturate(upCommand[1], ubLampMinLevel, ubLampMaxLevel);
+				ubLampIntensityTarget = Saturate(uValue, ubLampMinLevel, ubLampMaxLevel);
 				if(ubLampIntensity != ubLampIntensityTarget)
 				{
 					uFadeInterval = ulFadeIntervalTable[ubLampFadeTime] / abs(ubLampIntensityTarget - ubLampIntensity);
@@ -820,7 +1358,7 @@ u16	CmdLamp(void)
 		}
 		else
 		{	
-			uLampCmd = upCommand[1];
+			uLampCmd = uValue;
 			switch (uLampCmd)
 			{
 			case LAMP_OFF:
@@ -1073,7 +1611,7 @@ u16	CmdLamp(void)
 			case LAMP_REMOVE_FROM_GROUP13:					// 125
 			case LAMP_REMOVE_FROM_GROUP14:					// 126
 			case LAMP_REMOVE_FROM_GROUP15:					// 127
-				uLampGroupFlags &= !(1<<(uLampCmd & 0x0F));
+				uLampGroupFlags &= ~(1<<(uLampCmd & 0x0F));
 				break;
 
 			
@@ -1082,12 +1620,109 @@ u16	CmdLamp(void)
 		}
 	}
 
+}
 
-	WriteUARTValue(uStatus);	// Respond status to UART
 	
-	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up. 
-		
-	return (uStatus);		
+
+
+
+//==========================================================================================
+// Function:		LampAddressed()
+//
+// Description: 	Returns True if uAddr names this lamp: its own address, a group it
+//					belongs to (PLC_ADDR_GROUP | group number), or PLC_ADDR_BROADCAST.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 LampAddressed(u16 uAddr)
+{
+	if ((uAddr == uMyAddress) || (uAddr == PLC_ADDR_BROADCAST))
+		return (True);
+
+	if ((uAddr & 0xFFF0) == PLC_ADDR_GROUP)
+		return ((uLampGroupFlags & (1 << (uAddr & 0x0F))) ? True : False);
+
+	return (False);
+}
+
+
+//==========================================================================================
+// Function:		LampBatch()
+//
+// Description: 	Runs the entries of a lamp batch that address this lamp.  upBatch holds
+//					uLen bytes, one per word:
+//						0	CMD_LAMP_BATCH
+//						1	number of entries
+//					 2-		entries of LAMP_BATCH_ENTRY_LEN bytes:
+//							address high byte, address low byte (node, group or broadcast),
+//							CMD_LAMP_DIRECT or CMD_LAMP, intensity or LAMP command
+//					Entries are run in order, so a later entry overrides an earlier one
+//					for the same lamp.  Returns the number of entries that were run.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 LampBatch(const u16 *upBatch, u16 uLen)
+{
+	u16			i;
+	u16			uEntries;
+	u16			uRun = 0;
+	const u16	*upEntry;
+
+	if (uLen < 2)
+		return (0);
+	uEntries = Min(upBatch[1] & 0x00FF, (uLen-2) / LAMP_BATCH_ENTRY_LEN);
+
+	upEntry = &upBatch[2];
+	for (i=0; i<uEntries; i++, upEntry+=LAMP_BATCH_ENTRY_LEN)
+	{
+		if (!LampAddressed(((upEntry[0] & 0x00FF) << 8) | (upEntry[1] & 0x00FF)))
+			continue;
+		if ( ((upEntry[2] & 0x00FF) != CMD_LAMP_DIRECT) && ((upEntry[2] & 0x00FF) != CMD_LAMP) )
+			continue;
+
+		LampControl(upEntry[2] & 0x00FF, upEntry[3] & 0x00FF);
+		uRun++;
+	}
+
+	return (uRun);
+}
+
+
+//==========================================================================================
+// Function:		CmdLampBatch()
+//
+// Description: 	Runs a lamp batch (see LampBatch()) on this lamp.
+//					Parm #	Description
+//						0	Command number = 0025h
+//						1	number of entries
+//					 2-31	entries
+//
+//					Batches sent to PLC_ADDR_BROADCAST over the power line are run by
+//					ProcessRxPlcMsg() instead, without a reply.
+//					Returns SUCCESS and the number of entries that addressed this lamp.
+//
+//					NOTE: As a Cmd* function, this should only be called as the result of a
+//							command.  Code which needs to be called from other functions
+//							should be split into a new function.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 CmdLampBatch(void)
+{
+	u16	uStatus = SUCCESS;		// Return value.
+	u16	uRun;
+
+	uRun = LampBatch(upCommand, COMMAND_PARMS);
+
+	WriteUARTValue(uStatus);	// Respond status to UART
+	WriteUARTValue(uRun);
+
+	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up.
+
+	return (uStatus);
 }
 
 	
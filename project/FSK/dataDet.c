@@ -37,7 +37,6 @@
 #define PLL_THYST_THRS		4      		// time samples
 #define PLL_HOLD_THRS		110			// sample detBit signal above this point in pll.bitPhase
 
-#define AGC_THRS			(1500)		// control agcSignal to this amplitude 
 #define AGC_ENABLE			True		// turn on Automatic Gain Control
 
 
@@ -140,6 +139,12 @@ Revision History:
 01Feb05	Hagen	Created function
 25Feb05	Hagen	added more comments
 07Mar05	Hagen	changed gainIndex inc from -96  to -48
+19Oct26			replaced the per-sample gain walk with a fast-attack AGC: the raw signal
+				level is measured over AGC_WIN_LEN samples and sGainIndex jumps straight
+				to the gainTable entry that brings it to AGC_MEAN_TARGET.  The gain is
+				frozen by pll.agcHold once the preamble is found.
+19Oct26			agcMean kept in s32 (a full-scale mean does not fit s16); unused
+				agcSignal removed.
 ==========================================================================================*/
 s16 runPLL(s16 signal )
 {
@@ -148,12 +153,39 @@ s16 runPLL(s16 signal )
 	u16				tabIndex;
 	s16				bcos, bsin;
 	s32				signal32;
-	s16				agcSignal;
 	static s16		agcGain	= (1<<AGC_SCALE);
+	s32				agcMean;				// mean |signal|, up to 32768
+	s16				lo, mid, hi;
 	
+	//---- fast-attack AGC: measure the raw signal level over a window -------------
+	//     and jump to the gain that brings it to the target amplitude
+	#if AGC_ENABLE == True
+		if( ~pll.agcHold )
+		{
+			pll.agcSum += (signal < 0) ? -(s32)signal : (s32)signal;
+			if( ++pll.agcCount >= AGC_WIN_LEN )
+			{
+				agcMean = pll.agcSum >> AGC_WIN_SHIFT;
+				lo = 0;
+				hi = GAIN_TABLE_LEN-1;
+				while( lo < hi )		// binary search for the largest gain that keeps
+				{						// the mean level at or below the target
+					mid = (lo + hi + 1) >> 1;
+					if( ((agcMean * (s32)gainTable[mid]) >> AGC_SCALE) > AGC_MEAN_TARGET )
+						hi = mid - 1;
+					else
+						lo = mid;
+				}
+				pll.sGainIndex = lo << GAIN_TABLE_SCALE;
+				agcGain = gainTable[lo];
+				pll.agcSum = 0;
+				pll.agcCount = 0;
+			}
+		}
+	#endif
+
 	//---- apply AGC gain and do coarse gain adjust -------------
-//	#if AGC_ENABLE == True // commented by Arefeen 062205
-	#if AGC_ENABLE == False
+	#if AGC_ENABLE == True
 		signal32 = ((s32)signal * (s32)agcGain) >>AGC_SCALE;
 		if (pll.agcHold == False)
 		{
@@ -198,11 +230,7 @@ s16 runPLL(s16 signal )
 	pll.phcos -= sinBuf[pll.firCnt];
 	sinBuf[pll.firCnt] = (s16)( ( (s32)(bcos) * (s32)(signal) ) >> 16 );
 	pll.phcos += sinBuf[pll.firCnt];
-	#if AGC_ENABLE == True
-		agcSignal  = abs(sinBuf[pll.firCnt++]);
-	#else
-		pll.firCnt++;
-	#endif
+	pll.firCnt++;
 
 	pll.phsin -= sinBuf[pll.firCnt];
 	sinBuf[pll.firCnt] = (s16)( ( (s32)(bsin) * (s32)(signal) ) >> 16 );
@@ -228,33 +256,12 @@ s16 runPLL(s16 signal )
 	}	// end pll hold
 
 
-	#if AGC_ENABLE == True
-		//---- adjust signal amplitude -------------
-		if( ~pll.agcHold )
-		{
-			if( agcSignal < AGC_THRS )
-			{
-				pll.sGainIndex++;
-				if( pll.sGainIndex > ((GAIN_TABLE_LEN-1)<<GAIN_TABLE_SCALE) )
-					pll.sGainIndex = ((GAIN_TABLE_LEN-1)<<GAIN_TABLE_SCALE);
-			}
-			else   
-			{
-				pll.sGainIndex -= 2;
-				if( pll.sGainIndex < 0 )
-					pll.sGainIndex = 0;
-	
-			}	 //end gain adjust
-			agcGain = gainTable[pll.sGainIndex>>GAIN_TABLE_SCALE];
-		}	// end agc hold
-	#endif
 
 
 	//---- diagnostics ---------------------
 	#if TRACE_BUF_LEN > 0
 		#ifdef DSP_COMPILE
 			SaveTrace(signal);		 
-			//SaveTrace(agcSignal);		 
 		    SaveTrace(pll.phcos);   
 		    //SaveTrace(pherr);		
 			//SaveTrace(pll.bitPhase);	
@@ -269,7 +276,7 @@ s16 runPLL(s16 signal )
 			//SaveTrace( pll.intPhase );
 			//SaveTrace( pll.proPhase );
 			//SaveTrace( pll.eta );
-			SaveTrace(agcSignal);
+			SaveTrace(agcGain);
 		#endif
 	#endif
 
@@ -385,7 +392,7 @@ void receive(s16 ADCsample)
 				uRxMode = FIND_WORDSYNC;
 				uRxModeCount = 0;
 				bitSample = True;
-//				pll.agcHold = True; //are
+				pll.agcHold = True;
 				detData = 0;
 				plcModeSnap = plcMode;
 				//if( plcModeSnap == RX_MODE )	// just a place to put a breakpoint
@@ -615,6 +622,8 @@ void reset_to_BitSync(void)
 	pll.phsin = 0;
 	pll.sigPower = 0;
 	pll.agcHold = False;
+	pll.agcSum = 0;
+	pll.agcCount = 0;
 	pll.intPhase = 0;
 	pll.proPhase = 0;
 	pll.sGainIndex = GAIN_TABLE_UNITY_IX;
@@ -27,19 +27,34 @@
 
 #define VHYST_THRS			100   		// vertical bits
 #define THYST_THRS			4      		// time samples
-#define BIT_DET_THRS		(SAM_PER_BIT/2)		// sample detBit at this point in bit window
-#define BIT_WIN_TOL			3			// amount to wait to see if a bit transition arrives
-#ifdef DSP_COMPILE
-	// Functions that will be run from RAM need to be assigned to 
-	// a different section.  This section will then be mapped using
-	// the linker cmd file.
-	#ifdef __cplusplus			// "C++"
-		#pragma CODE_SECTION("ramfuncs"); 
-	#else						// "C"
-//		#pragma CODE_SECTION(runPLL, "ramfuncs"); // Arefeen commented on 062705
-		#pragma CODE_SECTION(receive, "ramfuncs");
-	#endif
-#endif
+#define BIT_INTEG_SHIFT		5			// scale the bit integral down by this to get the soft bit
+
+#define BIT_CLK_INC			((u16)(65536L/SAM_PER_BIT))	// uBitClock step per sample (one bit = 2^16)
+#define BIT_CLK_HALF		0x8000		// middle of the bit window in uBitClock
+#define BIT_CLK_DET_DELAY	((THYST_THRS+1)*BIT_CLK_INC)	// hysteresis sees a transition this late
+#define BIT_TED_STEP		((s16)(BIT_CLK_INC/8))	// timing correction per transition (1/8 sample)
+#define BIT_CLK_ADJ_MAX		((s16)(BIT_CLK_INC/64))	// limit of the clock offset correction (~1.5%)
+
+#define DEMOD_BIAS_SHIFT	2			// loop gain of the demod bias estimator (per bit)
+#define DEMOD_BIAS_MAX		4096		// limit of the demod bias correction
+#define BIT_PAIR_SHIFT		4			// scale (I[k] +/- I[k-1]) down before the multiply,
+										// a full scale pair times BIT_PAIR_RECIP is near 2^31
+#define BIT_PAIR_RECIP		((s32)(65536L/(2*SAM_PER_BIT)))	// ((I[k] +/- I[k-1]) >> BIT_PAIR_SHIFT) *
+										// this >> (16 - BIT_PAIR_SHIFT) = mean
+#define QUAL_SOFT_SHIFT		4			// scale soft bits down so a packet of squares fits in u32
+#define DISC_BIAS_NOMINAL	(-2293)		// Q15 bias/half-swing of the discriminator with no offset
+										// (cos(2*pi*2*f/RX_Sampling) at the two tones)
+#define DISC_HZ_PER_RATIO	9561		// Hz of carrier offset per unit of bias/half-swing: 1 over
+										// the slope of (D(m)+D(s))/(D(m)-D(s)), D(f) = cos(4*pi*f/RX_Sampling),
+										// at the two tones (-1.046e-4 per Hz)
+#define DEMOD_ISI_Q15		((s32)(32768L - (32768L*ADCINT_COUNT_MAX)/(2*SAM_PER_BIT)))	// Q15 half swing
+										// of the bit integrals over that of the tones: the
+										// demod sum ramps over ADCINT_COUNT_MAX samples at a
+										// bit edge, half of the ramp in each bit
+#define DEMOD_TRUNC_BIAS	(-(ADCINT_COUNT_MAX/2))	// demod bias of the truncated products
+										// (-1/2 LSB each) summed in RxDemod()
+#define	RAMFUNCS_DATADET_NEW						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
 
 
 #ifdef MEX_COMPILE
@@ -63,6 +78,8 @@ u16		uRxMsgPending = 0;
 	Description:	simulate ADC interupt 	
 
 	Revision History:
+	19Oct26			Samples pass through the channel model when chanCfg.uEnable is set.
+	19Oct26			Samples go through RxDemod() like in adc_isr().
 ==========================================================================================*/
 u16 processReadSamples( dCplxPtr rec)
 {
@@ -82,6 +99,8 @@ u16 processReadSamples( dCplxPtr rec)
 	{
 		#ifdef MEX_COMPILE
 			ADCsample = (s16)(*(rec.r++));
+			if (chanCfg.uEnable == True)
+				ADCsample = ChanSample(ADCsample);	// line model (channel.c)
 			sampleCount++;
 		#else
 		//---- get the ADC sample ------------------------------ 
@@ -93,7 +112,11 @@ u16 processReadSamples( dCplxPtr rec)
 				ADCIntCount = 0;
 		#endif
 
-		receive(ADCsample);
+		#ifdef MEX_COMPILE
+			receive(RxDemod(ADCsample));	// same receive path as adc_isr()
+		#else
+			receive(ADCsample);
+		#endif
 
 	}
 
@@ -104,6 +127,26 @@ u16 processReadSamples( dCplxPtr rec)
 #endif
 
 
+//---- link quality of the packet being received ---------------
+u32		ulQualSoftSum = 0;			// sum of soft bits (scaled by QUAL_SOFT_SHIFT)
+u32		ulQualSoftSq = 0;			// sum of squared soft bits
+u16		uQualSoftCnt = 0;			// number of soft bits summed
+u32		ulQualTimSum = 0;			// sum of |boundary sample| at bit transitions
+u16		uQualTimCnt = 0;			// number of transitions summed
+u16		uQualBitErrs = 0;			// codewords with parity errors
+
+//---- receive() state, cleared by ReceiveReset() ----------------
+static u16	bitNum;						// count the bits in a byte
+static u16	detData  = 0;				// receive data word
+static u16	detBit = 0;					// squared-up version of phase data
+static s16	bitSample = False;			// flag used to sample detBit in FIND_DATA
+static u16	uEOP_holdOffCnt = 0;		// time to wait before transmitting
+static s32	bitAcc = 0;					// integral of demodSample over the bit window
+static s32	prevBitAcc = 0;				// integral of the previous bit
+static s16	boundarySample = 0;			// demodSample at the start of the current bit
+static s16	sBitClkKick = 0;			// timing correction to apply with the next clock step
+
+
 /*==========================================================================================
 Function:		receive()
 
@@ -128,23 +171,49 @@ Revision History:
 				can start to look for a packet right after receiving one, but wait to TX.
 				Also changed FIND_BITSYNC bit window timeout to reset on too big and too small bit times
 07Mar05	Hagen	added Parity error check
+19Oct26			replaced the single detBit sample at BIT_DET_THRS with an integrate-and-dump
+				slicer: demodSample is summed over the bit window and the bit is decided on
+				the sign of the sum at BIT_INTEG_END, or early if the next transition
+				arrives first.  The magnitude of the sum is kept in uSoftBit.
+				The bit window tracking is now common to all states.
+19Oct26			bit timing is a fractional bit clock (uBitClock) instead of a sample counter.
+				detBit transitions only align the clock while looking for the preamble;
+				after that a Gardner detector (sign of the boundary sample against the
+				change between bit integrals) nudges the phase and the clock rate, so
+				the window stays centred over long runs and between boards whose
+				crystals differ.
+19Oct26			the demod DC bias is estimated from pairs of bit integrals while looking for
+				the preamble and subtracted from demodSample.  At preamble detection the
+				bias and the carrier offset it implies are latched into sRxDemodBias and
+				sRxFreqOffset for the packet.
+19Oct26			the demod bias loop only runs on pairs of opposite bits, and while looking
+				for the preamble only inside an alternating run.  The carrier offset
+				uses the slope of the discriminator at the tones, and takes the bit
+				edge ramp and the product truncation out of the bias and the swing.
+19Oct26			link quality of each packet (soft bit statistics, timing error at the
+				transitions, parity errors) is collected from the preamble to the EOP and
+				latched into rxQuality by RxQualityLatch().
+19Oct26			host build reports bitPhase and the mode word to GoldenTrace(), the same
+				words the target puts in the trace buffer.
+19Oct26			state moved out of the function so ReceiveReset() can clear it.  The
+				hysteresis counter and polarity are the datadet.h globals that
+				reset_to_BitSync() already cleared.
 ==========================================================================================*/
 void receive(s16 demodSample)
 {
-	static u16	bitNum;					// count the bits in a byte
-	static u16	detData  = 0;			// receive data word
-	static u16  detBit = 0;				// squared-up version of phase data
-	static s16  bitSample = False;		// flag used to sample detBit in FIND_DATA
-	static u16 	uEOP_holdOffCnt = 0;	// time to wait before transmitting
-//	static u16 	histCnt = 0;			// hysteresis counter
-	static u16  hystCnt = 0;
-	static s16	bitPhase = 0;			// counter representing the phase within a bit window  
-	static s16	polarity;				// polarity of the data, based on detection of WORDSYNC
-
 	u16			bitTransition = False;	// flag used to sample detBit in FIND_BITSYNC
+	u16			bitDump = False;		// flag: bit integral is complete, decide the bit
+	u16			sliceBit = 0;			// bit decided from the sign of the bit integral
+	u16			prevClock;				// uBitClock before this sample
+	s32			pairMean;				// mean demod over the last two bits
 	s16			diagSample = 0;			// flag used to generate trace data 
 
 
+	PROF(PROF_RECEIVE);					// host call count (prof.c)
+
+	//---- remove the discriminator bias (carrier offset) -----------------
+	demodSample -= sDemodBias;
+
 	//---- apply time and voltage hysteresis to the demod data to squar it up -------
 	if( detBit == 1 )							// detBit is pos
 	{
@@ -173,6 +242,85 @@ void receive(s16 demodSample)
 		}
 	}
 
+
+	//---- advance the bit clock ----------------------------------------
+	prevClock = uBitClock;
+	uBitClock = (uBitClock + BIT_CLK_INC + sBitClkAdj + sBitClkKick) & 0xFFFF;	// u16 is 32 bits on the host
+	sBitClkKick = 0;
+
+	if( (uRxMode == FIND_BITSYNC) || (uRxMode == EOP_HOLD_OFF) )
+	{
+		//---- acquisition: align the bit clock to each detected transition ------
+		if( bitTransition )
+		{
+			if( prevClock > BIT_CLK_HALF )
+				bitDump = True;			// next bit arrived before the clock wrapped
+			uBitClock = BIT_CLK_DET_DELAY;
+		}
+		else if( uBitClock < prevClock )
+			bitDump = True;				// bit boundary
+	}
+	else if( uBitClock < prevClock )
+	{
+		bitDump = True;					// bit boundary
+	}
+	bitPhase = (u16)(((u32)uBitClock * SAM_PER_BIT) >> 16);	// sample index within the bit
+
+	//---- integrate and dump: decide the bit on the sign of the integral -------
+	if( bitDump )
+	{
+		sliceBit = (bitAcc >= 0) ? 1 : 0;
+
+		//---- Gardner timing error: (I[k] - I[k-1]) * y[k-1/2] --------------
+		// On a transition the boundary sample should be zero.  If it already has
+		// the sign of the new bit the window is late, so advance the clock.
+		if( (uRxMode != FIND_BITSYNC) && (uRxMode != EOP_HOLD_OFF) 
+			&& ((bitAcc >= 0) != (prevBitAcc >= 0)) && (boundarySample != 0) )
+		{
+			ulQualTimSum += (boundarySample < 0) ? -boundarySample : boundarySample;
+			uQualTimCnt++;
+
+			if( (boundarySample > 0) == (sliceBit == 1) )
+			{
+				sBitClkKick = BIT_TED_STEP;
+				if( sBitClkAdj < BIT_CLK_ADJ_MAX )
+					sBitClkAdj++;
+			}
+			else
+			{
+				sBitClkKick = -BIT_TED_STEP;
+				if( sBitClkAdj > -BIT_CLK_ADJ_MAX )
+					sBitClkAdj--;
+			}
+		}
+
+		//---- demod bias: over two opposite bits the mean is the residual bias -----
+		//     and the mean difference is the half swing.  While looking for the
+		//     preamble only bits that continue an alternating run count, so the
+		//     loop holds still on noise.
+		if( ((bitAcc >= 0) != (prevBitAcc >= 0))
+			&& ( ((uRxMode != FIND_BITSYNC) && (uRxMode != EOP_HOLD_OFF))
+				|| (((detData ^ (detData >> 1)) & 0x7) == 0x7) ) )
+		{
+			pairMean = (((bitAcc + prevBitAcc) >> BIT_PAIR_SHIFT) * BIT_PAIR_RECIP) >> (16 - BIT_PAIR_SHIFT);
+			sDemodBias += (s16)(pairMean >> DEMOD_BIAS_SHIFT);
+			sDemodBias = Saturate(sDemodBias, -DEMOD_BIAS_MAX, DEMOD_BIAS_MAX);
+
+			pairMean = (((bitAcc - prevBitAcc) >> BIT_PAIR_SHIFT) * BIT_PAIR_RECIP) >> (16 - BIT_PAIR_SHIFT);
+			pairMean = (pairMean < 0) ? -pairMean : pairMean;
+			sDemodSwing += (s16)((pairMean - sDemodSwing) >> DEMOD_BIAS_SHIFT);
+		}
+
+		prevBitAcc = bitAcc;
+		boundarySample = demodSample;
+
+		bitAcc = (bitAcc < 0) ? -bitAcc : bitAcc;
+		bitAcc >>= BIT_INTEG_SHIFT;
+		uSoftBit = (bitAcc > 0x7FFF) ? 0x7FFF : (u16)bitAcc;
+		bitAcc = 0;
+	}
+	bitAcc += demodSample;
+
 	
 	//---- look for information depending on state of modem -------------	
 	switch( uRxMode	)
@@ -189,7 +337,6 @@ void receive(s16 demodSample)
 	//---- look for bitSync -------------------------------
 	case FIND_BITSYNC:
 		//uRxModeCount++;
-		bitPhase++;
 /*		if( bitTransition )
 		{
 			//---- reset if too long or too short between bit transitions -----------
@@ -203,19 +350,9 @@ void receive(s16 demodSample)
 			diagSample = 1;
 */
 
-
-		if( bitTransition )
-		{
-			bitPhase = 0;			// reset counter for phase inside bit window
-		}
-		if( bitPhase >= SAM_PER_BIT+11 )
+		if( bitDump )
 		{
-			bitPhase -= SAM_PER_BIT;  // reset counter for phase inside bit window
-		}
-
-		if( bitPhase == BIT_DET_THRS )
-		{
-			detData = (detData << 1) | detBit; // detect the data!
+			detData = ((detData << 1) | sliceBit) & 0xFFFF; // detect the data! (u16 is 32 bits on the host)
 			diagSample = 1;
 
 
@@ -238,9 +375,31 @@ void receive(s16 demodSample)
 				//SetLED(PLC_RX_BUSY_LED,  1);// Turn RX BUSY LED ON
 				SetLED(PLC_RX_GOOD_LED,  0);// Turn RX GOOD LED OFF	
 
+				uZcRxBin = uZcBin;				// mains phase of this packet
+
+				//---- report the bias and the carrier offset it implies --------
+				sRxDemodBias = sDemodBias;
+				sRxFreqOffset = 0;
+				if( sDemodSwing > 0 )
+				{
+					pairMean = Sat16( ((s32)(sDemodBias - DEMOD_TRUNC_BIAS) * DEMOD_ISI_Q15) / sDemodSwing );	// Q15 bias/half-swing
+					pairMean = ((DISC_BIAS_NOMINAL - pairMean) * DISC_HZ_PER_RATIO) >> 15;
+					sRxFreqOffset = Sat16(pairMean);
+				}
+
+				//---- start the link quality measurement of this packet ---------
+				rxQuality.uRssi = Log2Q1( (sDemodSwing > 0) ? sDemodSwing : 0 );
+				rxQuality.sFreqOffset = sRxFreqOffset;
+				ulQualSoftSum = 0;
+				ulQualSoftSq = 0;
+				uQualSoftCnt = 0;
+				ulQualTimSum = 0;
+				uQualTimCnt = 0;
+				uQualBitErrs = 0;
+
 				#ifdef MEX_COMPILE
 					#if MEX_VERBOSE
-					mexPrintf("preamble found at sample %d\n", sampleCount);
+					mexPrintf("preamble found at sample %d, offset %d Hz\n", sampleCount, sRxFreqOffset);
 					#endif
 		   		#endif
 			}
@@ -250,26 +409,12 @@ void receive(s16 demodSample)
 
 	//---- look for WordSync -------------------------------
 	case FIND_WORDSYNC:
-		bitPhase++;
-
-		if( bitTransition )
-		{
-			bitPhase = 0;			// reset counter for phase inside bit window
-			//bitSample = True;		// enable detecting bit value
-		}
-		if( bitPhase >= SAM_PER_BIT+BIT_WIN_TOL )
-		{
-			bitPhase -= SAM_PER_BIT;  // reset counter for phase inside bit window
-			//bitSample = True;		  // enable detecting bit value
-		}
-
-		//if( bitPhase >= BIT_DET_THRS )
-		if( bitPhase == BIT_DET_THRS )
+		if( bitDump )
 		{
 			//if( bitSample )
 			{
 				//bitSample = False;		// disable detecting the bit after this
-				detData = (detData << 1) | detBit; // detect the data!
+				detData = ((detData << 1) | sliceBit) & 0xFFFF; // detect the data! (u16 is 32 bits on the host)
 				diagSample = 1;
 
 				//---- look for WordSync ------------
@@ -307,6 +452,7 @@ void receive(s16 demodSample)
 					reset_to_BitSync();
 					detData = 0;
 					ulPlcStats[RX_ERR_WORDSYNC_TO][plcModeSnap]++;	// Count WordSync timeouts
+					ZcCountRx(ZC_RX_ERR);
 					#ifdef MEX_COMPILE
 						#if MEX_VERBOSE
 						mexPrintf("WordSync not found\n");
@@ -316,35 +462,26 @@ void receive(s16 demodSample)
 				}
 
 			}		// if( bitSample )
-		}			// if( bitTransition )
+		}			// if( bitDump )
 
 		break;
 
 	//---- look for data --------------------------------------
 	case FIND_DATA:
 	case FIND_EOP:
-		bitPhase++;
-
-		if( bitTransition )
-		{
-			bitPhase = 0;			// reset counter for phase inside bit window
-			//bitSample = True;		// enable detecting bit value
-		}
-		if( bitPhase >= SAM_PER_BIT+BIT_WIN_TOL )
-		{
-			bitPhase -= SAM_PER_BIT;  // reset counter for phase inside bit window
-			//bitSample = True;		  // enable detecting bit value
-		}
-
-		//if( bitPhase >= BIT_DET_THRS )
-		if( bitPhase == BIT_DET_THRS )
+		if( bitDump )
 		{
 			//if( bitSample )
 			{
 				bitSample = False;
-				detData = (detData << 1) | (detBit^polarity);
+				detData = (detData << 1) | (sliceBit^polarity);
 				diagSample = 1;
 
+				pairMean = uSoftBit >> QUAL_SOFT_SHIFT;	// soft bit statistics for the SNR
+				ulQualSoftSum += pairMean;
+				ulQualSoftSq  += pairMean * pairMean;
+				uQualSoftCnt++;
+
 				//---- process a byte of data ------------
 				bitNum--;
 				if( bitNum == 0 )
@@ -355,6 +492,7 @@ void receive(s16 demodSample)
 						reset_to_BitSync();
 						detData = 0;
 			   			ulPlcStats[RX_EOP_TIMEOUT][plcModeSnap]++;		// 
+						ZcCountRx(ZC_RX_ERR);
 						#ifdef MEX_COMPILE
 							#if MEX_VERBOSE
 		 					mexPrintf("EOP not found.  state counter = %d\n", uRxModeCount );
@@ -368,6 +506,7 @@ void receive(s16 demodSample)
 						reset_to_BitSync();
 						detData = 0;
 			   			ulPlcStats[RX_MSGLEN_ERROR][plcModeSnap]++;		// 
+						ZcCountRx(ZC_RX_ERR);
 						#ifdef MEX_COMPILE
 							#if MEX_VERBOSE
 		 					mexPrintf("RX message too long.\n");
@@ -381,6 +520,7 @@ void receive(s16 demodSample)
 					{
 						uRxMsgPending = True;	// Indicate received message pending.  
 			   			ulPlcStats[RX_EOP_COUNT][plcModeSnap]++; 	// Count EOP patterns found 
+						RxQualityLatch();		// link quality of this packet
 						
 						reset_to_BitSync(); 	// well, almost bitSync
 						uRxMode = EOP_HOLD_OFF;	// initialize everything but wait to TX
@@ -400,6 +540,7 @@ void receive(s16 demodSample)
 					if( (uRxMode == FIND_DATA) && ( rxUserDataArray[uRxByteCount] != uTxPrecodeTable[detData>>3] ) )
 					{
 						ulPlcStats[RX_ERR_PARITY][plcModeSnap]++; 	// Count EOP patterns found 
+						uQualBitErrs++;
 					}
 					
 					uRxByteCount++;
@@ -408,7 +549,7 @@ void receive(s16 demodSample)
 
 				}	// if( bitnum )
 			}		// if( bitSample )
-		}			// if( bitTransition )
+		}			// if( bitDump )
 
 		break;
 
@@ -432,6 +573,10 @@ void receive(s16 demodSample)
 	#else
 		diagSample = diagSample;
 	#endif
+	#ifdef MEX_COMPILE
+		GoldenTrace( bitPhase );	// same words as the target trace, for GoldenCheck()
+		GoldenTrace( (uRxMode<<2) + (bitTransition<<1) + detBit );
+	#endif
 
 	return;
 }
@@ -439,6 +584,99 @@ void receive(s16 demodSample)
 
 
 
+/*==========================================================================================
+Function:		RxQualityLatch()
+
+Description: 	Called when the EOP of a packet is found.  Computes the link quality of
+				the packet into rxQuality and adds it to the ulRxQualHist[] histograms.
+
+				uRssi		2*log2 of the demod half swing at the preamble.  The swing is
+							proportional to the received power, so one step is 1.5 dB.
+				uSnr		2*log2 of mean^2/variance of the soft bits over the data,
+							1.5 dB steps.
+				uTimingErr	mean |demod| at the bit transitions relative to the half
+							swing, Q4.  A centred bit clock sees zero at the transitions.
+				uBitErrs	codewords received with a parity error.
+
+				Histogram bins are 3 dB for uRssi and uSnr, one Q4 step for uTimingErr
+				and one codeword for uBitErrs.  The last bin collects everything above.
+
+Revision History:
+19Oct26			New Function.
+==========================================================================================*/
+void RxQualityLatch(void)
+{
+	u32			ulMean;				// mean soft bit
+	u32			ulVar;				// variance of the soft bits
+	u32			ulTim;				// mean |boundary sample|
+
+	PROF(PROF_RXQUALITYLATCH);					// host call count (prof.c)
+
+	//---- SNR from the soft bits ---------------------
+	rxQuality.uSnr = 0;
+	if( uQualSoftCnt > 1 )
+	{
+		ulMean = ulQualSoftSum / uQualSoftCnt;
+		ulVar  = ulQualSoftSq / uQualSoftCnt - ulMean * ulMean;
+		if( ulVar == 0 )
+			ulVar = 1;
+		rxQuality.uSnr = Log2Q1( (ulMean * ulMean) / ulVar );
+	}
+
+	//---- timing error at the transitions ----------------
+	rxQuality.uTimingErr = 0;
+	if( (uQualTimCnt > 0) && (sDemodSwing > 0) )
+	{
+		ulTim = ((ulQualTimSum / uQualTimCnt) << 4) / (u16)sDemodSwing;
+		rxQuality.uTimingErr = (ulTim > 0x7FFF) ? 0x7FFF : (u16)ulTim;
+	}
+
+	rxQuality.uBitErrs = uQualBitErrs;
+
+	//---- histograms -------------------------------------
+	ulRxQualHist[QUAL_RSSI  ][Min(rxQuality.uRssi >> 1,   QUAL_HIST_BINS-1)]++;
+	ulRxQualHist[QUAL_SNR   ][Min(rxQuality.uSnr >> 1,    QUAL_HIST_BINS-1)]++;
+	ulRxQualHist[QUAL_TIMING][Min(rxQuality.uTimingErr,   QUAL_HIST_BINS-1)]++;
+	ulRxQualHist[QUAL_BITERR][Min(rxQuality.uBitErrs,     QUAL_HIST_BINS-1)]++;
+
+	#ifdef MEX_COMPILE
+		#if MEX_VERBOSE
+		mexPrintf("quality: rssi %d snr %d timing %d parity %d\n", rxQuality.uRssi,
+			rxQuality.uSnr, rxQuality.uTimingErr, rxQuality.uBitErrs);
+		#endif
+	#endif
+
+	return;
+}
+
+
+/*==========================================================================================
+Function:		Log2Q1()
+
+Description: 	Returns about 2*log2(ulX): twice the position of the highest set bit,
+				plus one if the next bit is also set.  Returns 0 for ulX < 2.
+
+Revision History:
+19Oct26			New Function.
+==========================================================================================*/
+u16 Log2Q1(u32 ulX)
+{
+	u16			uLog = 0;
+
+	PROF(PROF_LOG2Q1);					// host call count (prof.c)
+
+	if( ulX < 2 )
+		return 0;
+
+	while( ulX >= 4 )
+	{
+		ulX >>= 1;
+		uLog += 2;
+	}
+	return uLog + ((ulX == 3) ? 3 : 2);
+}
+
+
 /*==========================================================================================
 Function:		reset_to_BitSync()
 
@@ -450,14 +688,20 @@ Globals:
 
  Revision History:
  01/28/05	Hagen	New Function
+ 19Oct26			demod bias back to that of a carrier without offset, at the last swing.
 ==========================================================================================*/
 void reset_to_BitSync(void)
 {
+	PROF(PROF_RESET_TO_BITSYNC);					// host call count (prof.c)
+
 	uRxMode = FIND_BITSYNC;
 	uRxModeCount = 0;
 	bitPhase = 0;
 	polarity = 0;
 	hystCnt = 0;
+	uBitClock = 0;
+	sBitClkAdj = 0;
+	sDemodBias = (s16)(((s32)DISC_BIAS_NOMINAL * sDemodSwing) / DEMOD_ISI_Q15) + DEMOD_TRUNC_BIAS;	// no carrier offset
 
 	demod = 0;
 	memset(demodBuf, 0, ADCINT_COUNT_MAX*sizeof(s16));
@@ -490,6 +734,44 @@ void reset_to_BitSync(void)
 }
 
 
+/*==========================================================================================
+Function:		ReceiveReset()
+
+Description: 	Clear all receive() state, including what reset_to_BitSync() keeps
+				from packet to packet (bit clock rate, demod bias and swing), as after
+				a power up.  Used by the host golden vector checks, which must start
+				every run from the same state.
+
+Revision History:
+19Oct26			New function.
+==========================================================================================*/
+void ReceiveReset(void)
+{
+	bitNum = 0;
+	detData = 0;
+	detBit = 0;
+	bitSample = False;
+	uEOP_holdOffCnt = 0;
+	bitAcc = 0;
+	prevBitAcc = 0;
+	boundarySample = 0;
+	sBitClkKick = 0;
+
+	sDemodBias = 0;
+	sDemodSwing = 0;
+	uSoftBit = 0;
+
+	ulQualSoftSum = 0;
+	ulQualSoftSq = 0;
+	uQualSoftCnt = 0;
+	ulQualTimSum = 0;
+	uQualTimCnt = 0;
+	uQualBitErrs = 0;
+
+	reset_to_BitSync();				// mode, bit clock, hysteresis, demodBuf
+}
+
+
 
 
 
@@ -503,19 +785,32 @@ Description: 	This function processes the message in the rxUserDataArray looking
 Revision History:
 08/12/04	HEM		New Function.
 08/17/04	HEM		Added parity checking.
+19Oct26			FEC decode ahead of the CRC check.
+19Oct26			Run broadcast lamp batches.
+19Oct26			Accept group and broadcast frames.
+19Oct26			Hand relay frames to RelayReceive().
 //==========================================================================================*/
 void ProcessRxPlcMsg(void)
 {
 	u16			i;					// Loop counter
 	u16			*upCmd;				// working pointer
 	u16			uRxMsgLen;			// Message length (words)
+	u16			uDest;				// Destination address of the frame
 	
 	#if	USE_CRC  == True
 		u16		uCRCcalc;
 		u16		uCRCrec;
 	#endif
+	#if FEC_ENABLE == True
+		u16		uFecCorr;			// bytes repaired by the FEC decoder
+	#endif
+	#if PLC_MULTICAST == True
+		u16		upFrame[MAX_RX_MSG_LEN];	// group or broadcast frame, one byte per word
+	#endif
 
 
+	PROF(PROF_PROCESSRXPLCMSG);					// host call count (prof.c)
+
 	ulPlcStats[RX_CNT][plcModeSnap]++; 	// Increment total receive packet counter		
 
 	//---- find the location of the EOP byte (there may be two) ----
@@ -525,6 +820,22 @@ void ProcessRxPlcMsg(void)
 	if( rxUserDataArray[uRxMsgLen] == 0xE660 )
 		uRxMsgLen--;
 		
+	//---- repair the frame and strip the FEC parity ----------
+	#if FEC_ENABLE == True
+		if (uRxMsgLen < FEC_PARITY_LEN + 1)
+		{
+			ulPlcStats[RX_MSGLEN_ERROR][plcModeSnap]++;
+			uRxMsgPending = ~True;
+			return;
+		}
+		uFecCorr = FecDecodeRx(uRxMsgLen+1);
+		if (uFecCorr == FEC_FAIL)
+			ulPlcStats[RX_FEC_FAIL][plcModeSnap]++;
+		else
+			ulPlcStats[RX_FEC_CORRECTED][plcModeSnap] += uFecCorr;
+		uRxMsgLen -= FEC_PARITY_LEN;
+	#endif
+
 
 	//---- Compare sent CRC to calculated CRC -----------------
 	#if	USE_CRC	  
@@ -535,23 +846,65 @@ void ProcessRxPlcMsg(void)
 		if (uCRCrec == uCRCcalc)
 		{
 			ulPlcStats[RX_GOOD][plcModeSnap]++; // Increment good packet counter
+			ZcCountRx(ZC_RX_GOOD);
 			SetLED(PLC_RX_GOOD_LED,  1);		// Turn RX GOOD LED ON	
 
+			uDest = (rxUserDataArray[0]&0xFF00) | (rxUserDataArray[1]>>8);
+
 			// If this message is addressed to me, copy it into my command buffer 
 			// and set flags to execute it in main loop
-			if ( ((rxUserDataArray[0]&0xFF00) | (rxUserDataArray[1]>>8))  == uMyAddress)	
+			if (uDest == uMyAddress)	
 			{	
 				upCmd = upCommand;
 				for (i= 2; i<uRxMsgLen-1; i++)
 				{
 					*upCmd++ = (rxUserDataArray[i]>>8) & 0x00FF;
 				} 
+				uCommandMulticast = False;
 				uCommandActive = 1;		// Command is now active - start running command task in main loop.
 			}
+			#if PLC_MULTICAST == True
+			// Sent to one of my groups or to everybody.  Run it the same way, but
+			// commands must not answer on the power line (uCommandMulticast)
+			else if ( (uRxMsgLen > 3) && LampAddressed(uDest) )
+			{
+				for (i= 2; i<uRxMsgLen-1; i++)
+				{
+					upFrame[i-2] = (rxUserDataArray[i]>>8) & 0x00FF;
+				}
+
+				#if LAMP_BATCH == True
+				// A lamp batch is run here by every node
+				if (upFrame[0] == CMD_LAMP_BATCH)
+				{
+					LampBatch(upFrame, uRxMsgLen-3);
+				}
+				else
+				#endif
+				#if RELAY_ENABLE == True
+				// Multi-hop frame: run and/or repeat it
+				if (upFrame[0] == CMD_RELAY)
+				{
+					RelayReceive(upFrame, uRxMsgLen-3);
+				}
+				else
+				#endif
+				{
+					upCmd = upCommand;
+					for (i= 2; i<uRxMsgLen-1; i++)
+					{
+						*upCmd++ = (rxUserDataArray[i]>>8) & 0x00FF;
+					} 
+					uCommandMulticast = True;
+					uCommandActive = 1;
+				}
+			}
+			#endif
 		}
 		else  // CRC failed to match
 		{
 			ulPlcStats[RX_ERR_CRC][plcModeSnap]++;	// Increment CRC error counter
+			ZcCountRx(ZC_RX_ERR);
 		}
 	#endif
 
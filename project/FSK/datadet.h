@@ -64,6 +64,10 @@
 u16			bitPhase;
 u16			polarity;
 u16			hystCnt;
+u16			uBitClock;				// fractional phase within the bit window (one bit = 2^16)
+s16			sBitClkAdj;				// bit clock rate correction, tracks clock offset between boards
+s16			sDemodBias;				// demod DC bias removed before the slicer
+s16			sDemodSwing;			// half the demod swing between SET and MARK bits
 
 //---- complex array definition ------------------------------
 typedef struct
@@ -191,6 +195,9 @@ const s16	sinTable[] = 				// cosine and sine generator table for digital PLL
 #define GAIN_TABLE_SCALE		4		// sGainIndex is left shifted by this to index gainTable
 #define GAIN_TABLE_UNITY_IX		5		// gainTable index that represents a gain of 1.0 (actually 1.03)
 #define GAIN_TABLE_LEN			40		// length of gainTable
+#define AGC_WIN_SHIFT			6		// log2 of the fast-attack AGC measurement window
+#define AGC_WIN_LEN				(1<<AGC_WIN_SHIFT)	// samples averaged before each gain jump
+#define AGC_MEAN_TARGET			10430	// target mean |signal| after gain (half-scale sine: 16384*2/PI)
 
 const s16 gainTable[GAIN_TABLE_LEN] = 	// with AGC_SCALE set to 5,
 {										// the gain ranges from 0.5 to 43.4 in 1.25 dB steps 
@@ -48,6 +48,12 @@
 // Diag Trace command return codes
 #define ERR_TRACE_LIST_UNDEFINED		(0x0100)
 
+// Reliable PLC command return codes
+#define ERR_ARQ_BUSY					(0x0140)	// All ARQ_WINDOW slots wait for acks
+
+// Relayed PLC command return codes
+#define ERR_RELAY_BUSY					(0x0150)	// The last relay frame has not been sent yet
+
 
 
 // Channel Status Bit Masks and LEDs Error Codes
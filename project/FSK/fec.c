@@ -0,0 +1,555 @@
+//==========================================================================================
+// Filename:		fec.c
+//
+// Description:		Reed-Solomon forward error correction with byte interleaving.
+//
+//					With FEC_ENABLE the user data and CRC bytes of a frame are split into
+//					FEC_DEPTH interleaved blocks (byte i goes to block i % FEC_DEPTH), and
+//					FEC_NROOTS Reed-Solomon parity bytes over GF(256) are added per block.
+//					An impulse that wipes out a run of consecutive codewords is spread
+//					over the blocks.  Bytes whose 3 parity bits (uTxPrecodeTable) do not
+//					match are passed to the decoder as erasures, so a block corrects up
+//					to FEC_NROOTS flagged bytes, or FEC_NROOTS/2 unflagged ones.
+//
+//					Frame:	data (N bytes), CRC (2 bytes), parity (FEC_PARITY_LEN bytes).
+//							Byte p of the whole frame, parity included, is in block
+//							p % FEC_DEPTH, so a burst of FEC_DEPTH*k bytes costs each block k.
+//
+//					The code is RS(255,255-FEC_NROOTS) shortened, generator roots
+//					alpha^0..alpha^(FEC_NROOTS-1), field polynomial x^8+x^4+x^3+x^2+1.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+#ifdef MEX_COMPILE
+	#include <stdlib.h>					// rand()
+	#include <time.h>					// clock()
+#endif
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	FEC_NN				255			// symbols in a full length codeword
+#define	FEC_A0				FEC_NN		// log of zero
+#define	FEC_PRIM_POLY		0x11D		// x^8 + x^4 + x^3 + x^2 + 1
+#define	FEC_BLOCK_MAX		((MAX_RX_MSG_LEN + FEC_DEPTH - 1) / FEC_DEPTH)	// bytes per block
+
+
+//==========================================================================================
+// External Variables
+//==========================================================================================
+extern const u16 	uTxPrecodeTable[256];	// codeword with parity for each byte
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u32		ulFecCycles = 0;				// CPU cycles of the last FecDecodeRx()
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+u16		uFecExp[2*FEC_NN];				// alpha^i, doubled so sums of two logs need no modulo
+u16		uFecLog[FEC_NN+1];				// log_alpha(x), uFecLog[0] = FEC_A0
+u16		uFecGen[FEC_NROOTS+1];			// generator polynomial, log form
+
+
+//==========================================================================================
+// Function:		FecMod()
+//
+// Description: 	x modulo FEC_NN for x < 4*FEC_NN.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static inline u16 FecMod(u16 x)
+{
+	while (x >= FEC_NN)
+		x -= FEC_NN;
+	return (x);
+}
+
+
+//==========================================================================================
+// Function:		FecInit()
+//
+// Description: 	Build the GF(256) tables and the generator polynomial.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void FecInit(void)
+{
+	u16		i, j;
+	u16		sr;
+
+	sr = 1;
+	for (i=0; i<FEC_NN; i++)
+	{
+		uFecExp[i] = sr;
+		uFecExp[i+FEC_NN] = sr;
+		uFecLog[sr] = i;
+		sr <<= 1;
+		if (sr & 0x100)
+			sr ^= FEC_PRIM_POLY;
+	}
+	uFecLog[0] = FEC_A0;
+
+	//---- g(x) = (x - alpha^0)(x - alpha^1)...(x - alpha^(NROOTS-1)) ----
+	uFecGen[0] = 1;
+	for (i=0; i<FEC_NROOTS; i++)
+	{
+		uFecGen[i+1] = 1;
+		for (j=i; j>0; j--)
+		{
+			if (uFecGen[j] != 0)
+				uFecGen[j] = uFecGen[j-1] ^ uFecExp[uFecLog[uFecGen[j]] + i];
+			else
+				uFecGen[j] = uFecGen[j-1];
+		}
+		uFecGen[0] = uFecExp[uFecLog[uFecGen[0]] + i];
+	}
+	for (i=0; i<=FEC_NROOTS; i++)
+	{
+		uFecGen[i] = uFecLog[uFecGen[i]];
+	}
+}
+
+
+//==========================================================================================
+// Function:		FecEncodeBlock()
+//
+// Description: 	Systematic encoder: the FEC_NROOTS parity bytes of the uLen bytes at
+//					upData, taking every uStride'th byte.  Parity goes to upParity with
+//					the same stride.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void FecEncodeBlock(const u16 *upData, u16 uLen, u16 uStride, u16 *upParity)
+{
+	u16		i, j;
+	u16		bb[FEC_NROOTS];				// shift register
+	u16		uFeedback;
+
+	memset(bb, 0, sizeof(bb));
+	for (i=0; i<uLen; i++)
+	{
+		uFeedback = uFecLog[(upData[i*uStride] ^ bb[0]) & 0xFF];
+		for (j=0; j<FEC_NROOTS-1; j++)
+		{
+			bb[j] = bb[j+1];
+			if (uFeedback != FEC_A0)
+				bb[j] ^= uFecExp[uFeedback + uFecGen[FEC_NROOTS-1-j]];
+		}
+		bb[FEC_NROOTS-1] = (uFeedback != FEC_A0) ? uFecExp[uFeedback + uFecGen[0]] : 0;
+	}
+	for (j=0; j<FEC_NROOTS; j++)
+	{
+		upParity[j*uStride] = bb[j];
+	}
+}
+
+
+//==========================================================================================
+// Function:		FecEncode()
+//
+// Description: 	Parity bytes for the uLen message bytes at upMsg (data and CRC, one
+//					byte per word) into upParity[FEC_PARITY_LEN].
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void FecEncode(const u16 *upMsg, u16 uLen, u16 *upParity)
+{
+	u16		b;
+
+	for (b=0; b<FEC_DEPTH; b++)
+	{
+		FecEncodeBlock(&upMsg[b], (uLen + FEC_DEPTH-1 - b) / FEC_DEPTH, FEC_DEPTH,
+					   &upParity[(b + FEC_DEPTH - uLen % FEC_DEPTH) % FEC_DEPTH]);
+	}
+}
+
+
+//==========================================================================================
+// Function:		FecDecodeBlock()
+//
+// Description: 	Errors and erasures decoder for one block.  upCw holds uLen bytes
+//					(message then FEC_NROOTS parity) spaced uStride apart; upEras the
+//					uNumEras erased positions (0..uLen-1).  Corrects upCw in place.
+//					Returns the number of corrected bytes, or FEC_FAIL.
+//
+//					Syndromes, Berlekamp-Massey seeded with the erasure locator, Chien
+//					search and Forney, all with log/antilog tables.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u16 FecDecodeBlock(u16 *upCw, u16 uLen, u16 uStride, const u16 *upEras, u16 uNumEras)
+{
+	u16		i, j, r, k;
+	u16		uPad;						// symbols the code is shortened by
+	u16		s[FEC_NROOTS];				// syndromes, log form
+	u16		lambda[FEC_NROOTS+1];		// error + erasure locator
+	u16		b[FEC_NROOTS+1];
+	u16		t[FEC_NROOTS+1];
+	u16		omega[FEC_NROOTS+1];		// error evaluator, log form
+	u16		reg[FEC_NROOTS+1];
+	u16		root[FEC_NROOTS];
+	u16		loc[FEC_NROOTS];
+	u16		uSynError;
+	u16		uDiscr;
+	u16		uEl;
+	u16		uDegLambda, uDegOmega;
+	u16		uCount;
+	u16		q, tmp;
+	u16		num1, num2, den;
+
+	if ((uLen <= FEC_NROOTS) || (uLen > FEC_NN) || (uNumEras > FEC_NROOTS))
+		return (FEC_FAIL);
+	uPad = FEC_NN - uLen;
+
+	//---- syndromes: s[i] = c(alpha^i) ----------------------
+	for (i=0; i<FEC_NROOTS; i++)
+	{
+		s[i] = upCw[0] & 0xFF;
+	}
+	for (j=1; j<uLen; j++)
+	{
+		for (i=0; i<FEC_NROOTS; i++)
+		{
+			if (s[i] == 0)
+				s[i] = upCw[j*uStride] & 0xFF;
+			else
+				s[i] = (upCw[j*uStride] & 0xFF) ^ uFecExp[FecMod(uFecLog[s[i]] + i)];
+		}
+	}
+	uSynError = 0;
+	for (i=0; i<FEC_NROOTS; i++)
+	{
+		uSynError |= s[i];
+		s[i] = uFecLog[s[i]];
+	}
+	if (uSynError == 0)
+		return (0);						// codeword is clean
+
+	//---- erasure locator ------------------------------------
+	memset(lambda, 0, sizeof(lambda));
+	lambda[0] = 1;
+	if (uNumEras > 0)
+	{
+		lambda[1] = uFecExp[FecMod(FEC_NN-1 - (upEras[0]+uPad))];
+		for (i=1; i<uNumEras; i++)
+		{
+			k = FecMod(FEC_NN-1 - (upEras[i]+uPad));
+			for (j=i+1; j>0; j--)
+			{
+				tmp = uFecLog[lambda[j-1]];
+				if (tmp != FEC_A0)
+					lambda[j] ^= uFecExp[k + tmp];
+			}
+		}
+	}
+	for (i=0; i<=FEC_NROOTS; i++)
+	{
+		b[i] = uFecLog[lambda[i]];
+	}
+
+	//---- Berlekamp-Massey ------------------------------------
+	r = uNumEras;
+	uEl = uNumEras;
+	while (++r <= FEC_NROOTS)
+	{
+		uDiscr = 0;
+		for (i=0; i<r; i++)
+		{
+			if ((lambda[i] != 0) && (s[r-i-1] != FEC_A0))
+				uDiscr ^= uFecExp[uFecLog[lambda[i]] + s[r-i-1]];
+		}
+		uDiscr = uFecLog[uDiscr];
+		if (uDiscr == FEC_A0)
+		{
+			memmove(&b[1], b, FEC_NROOTS*sizeof(u16));
+			b[0] = FEC_A0;
+		}
+		else
+		{
+			t[0] = lambda[0];
+			for (i=0; i<FEC_NROOTS; i++)
+			{
+				if (b[i] != FEC_A0)
+					t[i+1] = lambda[i+1] ^ uFecExp[uDiscr + b[i]];
+				else
+					t[i+1] = lambda[i+1];
+			}
+			if (2*uEl <= r + uNumEras - 1)
+			{
+				uEl = r + uNumEras - uEl;
+				for (i=0; i<=FEC_NROOTS; i++)
+				{
+					b[i] = (lambda[i] == 0) ? FEC_A0 : FecMod(uFecLog[lambda[i]] + FEC_NN - uDiscr);
+				}
+			}
+			else
+			{
+				memmove(&b[1], b, FEC_NROOTS*sizeof(u16));
+				b[0] = FEC_A0;
+			}
+			memcpy(lambda, t, sizeof(lambda));
+		}
+	}
+
+	uDegLambda = 0;
+	for (i=0; i<=FEC_NROOTS; i++)
+	{
+		lambda[i] = uFecLog[lambda[i]];
+		if (lambda[i] != FEC_A0)
+			uDegLambda = i;
+	}
+
+	//---- Chien search: roots of lambda --------------------------
+	memcpy(&reg[1], &lambda[1], FEC_NROOTS*sizeof(u16));
+	uCount = 0;
+	for (i=1, k=0; i<=FEC_NN; i++, k=FecMod(k+1))
+	{
+		q = 1;
+		for (j=uDegLambda; j>0; j--)
+		{
+			if (reg[j] != FEC_A0)
+			{
+				reg[j] = FecMod(reg[j] + j);
+				q ^= uFecExp[reg[j]];
+			}
+		}
+		if (q != 0)
+			continue;
+		root[uCount] = i;
+		loc[uCount] = k;
+		if (++uCount == uDegLambda)
+			break;
+	}
+	if ((uDegLambda == 0) || (uCount != uDegLambda))
+		return (FEC_FAIL);				// more errors than the code can find
+
+	//---- omega = s * lambda mod x^NROOTS ------------------------
+	uDegOmega = uDegLambda - 1;
+	for (i=0; i<=uDegOmega; i++)
+	{
+		tmp = 0;
+		for (j=i+1; j>0; j--)
+		{
+			if ((s[i-j+1] != FEC_A0) && (lambda[j-1] != FEC_A0))
+				tmp ^= uFecExp[s[i-j+1] + lambda[j-1]];
+		}
+		omega[i] = uFecLog[tmp];
+	}
+
+	//---- Forney: error values -------------------------------------
+	for (j=uCount; j>0; j--)
+	{
+		num1 = 0;
+		for (i=uDegOmega+1; i>0; i--)
+		{
+			if (omega[i-1] != FEC_A0)
+				num1 ^= uFecExp[FecMod(omega[i-1] + (u32)(i-1) * root[j-1] % FEC_NN)];
+		}
+		num2 = uFecExp[FEC_NN - root[j-1]];				// alpha^(-root), first root alpha^0
+		den = 0;
+		for (i=(Min(uDegLambda, FEC_NROOTS-1) & ~1) + 2; i>=2; i-=2)
+		{
+			if (lambda[i-1] != FEC_A0)
+				den ^= uFecExp[FecMod(lambda[i-1] + (u32)(i-2) * root[j-1] % FEC_NN)];
+		}
+		if ((den == 0) || (loc[j-1] < uPad))
+			return (FEC_FAIL);			// error located in the shortened part
+		if (num1 != 0)
+		{
+			upCw[(loc[j-1]-uPad)*uStride] ^= uFecExp[FecMod(uFecLog[num1] + uFecLog[num2]
+											+ FEC_NN - uFecLog[den])];
+		}
+	}
+
+	return (uCount);
+}
+
+
+//==========================================================================================
+// Function:		FecGather()
+//
+// Description: 	Copy block uBlock of a received frame with uMsgLen data + CRC bytes out
+//					of rxUserDataArray into upCw, message then parity.  Bytes whose parity
+//					bits fail are listed in upEras.  Returns the number of such bytes, which
+//					may be more than fit in upEras.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u16 FecGather(u16 uBlock, u16 uMsgLen, u16 uBlkMsg, u16 *upCw, u16 *upEras)
+{
+	u16		n, i;
+	u16		uRxWord;
+	u16		uNumEras = 0;
+
+	for (n=0; n<uBlkMsg+FEC_NROOTS; n++)
+	{
+		if (n < uBlkMsg)
+			i = uBlock + n*FEC_DEPTH;
+		else
+			i = uMsgLen + (n-uBlkMsg)*FEC_DEPTH + (uBlock + FEC_DEPTH - uMsgLen % FEC_DEPTH) % FEC_DEPTH;
+		uRxWord = rxUserDataArray[i] & 0xFFFF;
+		upCw[n] = uRxWord >> 8;
+		if (uRxWord != uTxPrecodeTable[uRxWord >> 8])
+		{
+			if (uNumEras < FEC_NROOTS)
+				upEras[uNumEras] = n;
+			uNumEras++;
+		}
+	}
+	return (uNumEras);
+}
+
+
+//==========================================================================================
+// Function:		FecDecodeRx()
+//
+// Description: 	Called by ProcessRxPlcMsg() with the number of bytes ahead of the EOP.
+//					Decodes each block of the frame in rxUserDataArray, using the bytes with
+//					bad parity bits as erasures, and writes the corrected bytes back.  With
+//					more erasures than FEC_NROOTS, or if the erasure decode fails, the
+//					block is decoded again for errors only.
+//					Returns the number of corrected bytes, or FEC_FAIL if any block could
+//					not be decoded.  The CPU cycles used are left in ulFecCycles.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Cycles from the free-running counter, CpuTimer0 reloads every tick.
+//==========================================================================================
+u16 FecDecodeRx(u16 uCodedLen)
+{
+	u16		i, b, n;
+	u16		uMsgLen;					// data + CRC bytes
+	u16		uBlkMsg;					// message bytes in this block
+	u16		upCw[FEC_BLOCK_MAX];		// one block, message then parity
+	u16		upEras[FEC_NROOTS];			// erased positions in the block
+	u16		uNumEras;
+	u16		uCorr;
+	u16		uTotal = 0;
+	#ifdef DSP_COMPILE
+	u32		ulStart = CYCLE_COUNT();
+	#endif
+
+	if ((uCodedLen <= FEC_PARITY_LEN) || (uCodedLen > MAX_RX_MSG_LEN))
+		return (FEC_FAIL);
+	uMsgLen = uCodedLen - FEC_PARITY_LEN;
+
+	for (b=0; b<FEC_DEPTH; b++)
+	{
+		uBlkMsg = (uMsgLen + FEC_DEPTH-1 - b) / FEC_DEPTH;
+
+		uNumEras = FecGather(b, uMsgLen, uBlkMsg, upCw, upEras);
+		uCorr = FEC_FAIL;
+		if (uNumEras <= FEC_NROOTS)
+			uCorr = FecDecodeBlock(upCw, uBlkMsg+FEC_NROOTS, 1, upEras, uNumEras);
+		if ((uCorr == FEC_FAIL) && (uNumEras > 0))
+		{
+			FecGather(b, uMsgLen, uBlkMsg, upCw, upEras);		// undo a partial correction
+			uCorr = FecDecodeBlock(upCw, uBlkMsg+FEC_NROOTS, 1, upEras, 0);
+		}
+		if (uCorr == FEC_FAIL)
+		{
+			uTotal = FEC_FAIL;
+			break;
+		}
+		uTotal += uCorr;
+
+		//---- write back the message bytes ------------------------
+		for (n=0; n<uBlkMsg; n++)
+		{
+			i = b + n*FEC_DEPTH;
+			if (((rxUserDataArray[i] & 0xFFFF) >> 8) != upCw[n])
+				rxUserDataArray[i] = uTxPrecodeTable[upCw[n]];
+		}
+	}
+
+	#ifdef DSP_COMPILE
+	ulFecCycles = CYCLE_COUNT() - ulStart;
+	#endif
+
+	return (uTotal);
+}
+
+
+#ifdef MEX_COMPILE
+//==========================================================================================
+// Function:		FecBench()
+//
+// Description: 	Host benchmark for the MEX build.
+//					Encodes uFrames random frames of uLen bytes, wipes out a burst of
+//					uBurst consecutive bytes (flagged as erasures when uFlag is set, as the
+//					parity bits usually do), decodes them, and prints the success rate
+//					and the decode time per coded byte.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void FecBench(u16 uFrames, u16 uLen, u16 uBurst, u16 uFlag)
+{
+	u16		f, i;
+	u16		uStart;
+	u16		uCoded;
+	u16		upMsg[MAX_RX_MSG_LEN];
+	u16		uGood = 0;
+	clock_t	tStart, tTotal = 0;
+
+	FecInit();
+	uLen = Min(uLen, MAX_TX_MSG_LEN + 2);
+	uCoded = uLen + FEC_PARITY_LEN;
+	uBurst = Min(uBurst, uCoded);
+
+	for (f=0; f<uFrames; f++)
+	{
+		for (i=0; i<uLen; i++)
+		{
+			upMsg[i] = rand() & 0xFF;
+		}
+		FecEncode(upMsg, uLen, &upMsg[uLen]);
+		for (i=0; i<uCoded; i++)
+		{
+			rxUserDataArray[i] = uTxPrecodeTable[upMsg[i]];
+		}
+
+		uStart = rand() % (uCoded - uBurst + 1);
+		for (i=uStart; i<uStart+uBurst; i++)
+		{
+			rxUserDataArray[i] = uTxPrecodeTable[rand() & 0xFF];
+			if (uFlag)
+				rxUserDataArray[i] ^= 0x0020;	// bad parity bit
+		}
+
+		tStart = clock();
+		FecDecodeRx(uCoded);
+		tTotal += clock() - tStart;
+
+		for (i=0; (i<uLen) && ((rxUserDataArray[i] >> 8) == upMsg[i]); i++)
+			;
+		if (i == uLen)
+			uGood++;
+	}
+
+	mexPrintf("FEC RS(%d+%d)x%d, %d byte frames, burst %d (%s): %d/%d decoded, %.3f us/byte\n",
+		(uLen+FEC_DEPTH-1)/FEC_DEPTH, FEC_NROOTS, FEC_DEPTH, uLen, uBurst,
+		uFlag ? "erased" : "unflagged", uGood, uFrames,
+		1e6 * tTotal / CLOCKS_PER_SEC / ((double)uFrames * uCoded));
+}
+#endif
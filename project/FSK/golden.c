@@ -0,0 +1,324 @@
+//==========================================================================================
+// Filename:		golden.c
+//
+// Description:		Golden vectors for the receive chain (host build).
+//
+//					A golden vector is a recorded sequence of receive samples together
+//					with what the receive chain made of each one.  Every sample is a
+//					record of GOLDEN_WORDS words, the same four words the target puts
+//					in its trace buffer:
+//
+//						0	receive sample into RxDemod()
+//						1	demod out of RxDemod()
+//						2	bitPhase
+//						3	(uRxMode<<2) + (bitTransition<<1) + detBit
+//
+//					GoldenRecord() runs a sample file through RxDemod() and receive() and
+//					writes the records.  GoldenCheck() runs word 0 of each record
+//					through the same code and compares words 1 - 3 bit for bit, so a
+//					change to the fixed-point arithmetic shows up at the first sample
+//					it affects.  The expected records may come from GoldenRecord() or
+//					from a target trace buffer saved from the debugger (.dat).
+//
+//					Files are text: whitespace separated integers, decimal or 0x hex.
+//					A first line starting with 1651 (debugger .dat header) is skipped.
+//
+//					Every run starts from GoldenReset(), the receive chain as after a
+//					power up, so a target trace must start with the first sample after
+//					reset.
+//
+//					GoldenSynth() writes a sample file of a clean frame (FillTxBuffer()
+//					bits as SET/MARK tones at RX_Sampling).  golden/synth_in.txt is
+//					its output and golden/synth_gold.txt the records GoldenRecord()
+//					made of it; GoldenCheck("golden/synth_gold.txt") must pass after
+//					any change that is not meant to change the receive arithmetic.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			GoldenReset() and GoldenSynth(); synthetic vector in golden/.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdio.h>						// fopen(), fgets()
+#include <stdlib.h>						// malloc(), strtol()
+#include <string.h>						// strncmp()
+#include <math.h>						// sin(), floor()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	GOLDEN_WORDS		4			// words per sample record
+#define	GOLDEN_MAX			(1L << 22)	// most words read from one file
+#define	GOLDEN_REPORT		10			// mismatches printed
+#define	GOLDEN_PI			3.14159265358979
+#define	GOLDEN_SYNTH_LEN	8			// GoldenSynth(): message bytes
+#define	GOLDEN_SYNTH_GAP	1000		// GoldenSynth(): silent samples before and after
+#define	GOLDEN_SYNTH_AMP	8000.0		// GoldenSynth(): tone amplitude (ADC counts)
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static u16		uGoldenRec[GOLDEN_WORDS];	// record of the sample being processed
+static u16		uGoldenIdx = 0;
+
+
+//==========================================================================================
+// Function:		GoldenTrace()
+//
+// Description: 	Called by RxDemod() and receive() with each trace word.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void GoldenTrace(u16 uWord)
+{
+	if (uGoldenIdx < GOLDEN_WORDS)
+		uGoldenRec[uGoldenIdx++] = uWord & 0xFFFF;
+}
+
+
+//==========================================================================================
+// Function:		GoldenRead()
+//
+// Description: 	Read all integers of a file into a new buffer.  Returns the number
+//					of words, 0 if the file could not be read.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u32 GoldenRead(const char *pFile, u16 **upWords)
+{
+	FILE	*pF;
+	char	cLine[256];
+	char	*pPos, *pEnd;
+	long	lValue;
+	u32		ulLen = 0;
+	u16		uFirst = True;
+
+	*upWords = (u16 *)malloc(GOLDEN_MAX * sizeof(u16));
+	if (*upWords == 0)
+		return (0);
+	pF = fopen(pFile, "r");
+	if (pF == 0)
+		return (0);
+
+	while (fgets(cLine, sizeof(cLine), pF) != 0)
+	{
+		if (uFirst == True)
+		{
+			uFirst = False;
+			if (strncmp(cLine, "1651", 4) == 0)
+				continue;
+		}
+		pPos = cLine;
+		for (;;)
+		{
+			lValue = strtol(pPos, &pEnd, 0);
+			if ((pEnd == pPos) || (ulLen >= GOLDEN_MAX))
+				break;
+			(*upWords)[ulLen++] = (u16)(lValue & 0xFFFF);
+			pPos = pEnd;
+		}
+	}
+	fclose(pF);
+
+	return (ulLen);
+}
+
+
+//==========================================================================================
+// Function:		GoldenReset()
+//
+// Description: 	Put the whole receive chain back to its power up state: RxDemod()
+//					delay line, demod sum and blanker, and all receive() state.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void GoldenReset(void)
+{
+	RxDemodReset();
+	ReceiveReset();
+}
+
+
+//==========================================================================================
+// Function:		GoldenStep()
+//
+// Description: 	Run one receive sample through the receive chain and collect its
+//					record in uGoldenRec[].
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void GoldenStep(u16 uSample)
+{
+	uGoldenIdx = 0;
+	receive(RxDemod((s16)(short)uSample));
+}
+
+
+//==========================================================================================
+// Function:		GoldenRecord()
+//
+// Description: 	Run the receive samples in pInFile (one word per sample) through the
+//					receive chain and write one record per line to pOutFile.  Returns
+//					the number of samples, 0 on a file error.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Starts from GoldenReset().
+//==========================================================================================
+u32 GoldenRecord(const char *pInFile, const char *pOutFile)
+{
+	FILE	*pF;
+	u16		*upIn;
+	u32		ulLen, n;
+
+	ulLen = GoldenRead(pInFile, &upIn);
+	pF = (ulLen > 0) ? fopen(pOutFile, "w") : 0;
+	if (pF == 0)
+	{
+		free(upIn);
+		return (0);
+	}
+
+	GoldenReset();
+	for (n=0; n<ulLen; n++)
+	{
+		GoldenStep(upIn[n]);
+		fprintf(pF, "%d %d %u %u\n", (short)uGoldenRec[0], (short)uGoldenRec[1],
+			uGoldenRec[2], uGoldenRec[3]);
+	}
+	fclose(pF);
+	free(upIn);
+
+	mexPrintf("golden: %lu samples recorded to %s\n", (unsigned long)ulLen, pOutFile);
+	return (ulLen);
+}
+
+
+//==========================================================================================
+// Function:		GoldenCheck()
+//
+// Description: 	Check the receive chain against the records in pGoldenFile.  Prints
+//					the first GOLDEN_REPORT differences and a summary.  Returns the
+//					number of samples that differ in any word, 0xFFFFFFFF on a file
+//					error.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Starts from GoldenReset().
+//==========================================================================================
+u32 GoldenCheck(const char *pGoldenFile)
+{
+	static const char *cpWordName[GOLDEN_WORDS] = {"sample", "demod", "bitPhase", "mode"};
+	u16		*upGold;
+	u16		*upRec;
+	u32		ulLen, n;
+	u32		ulBad = 0;
+	u32		ulFirst = 0;
+	u16		i;
+
+	ulLen = GoldenRead(pGoldenFile, &upGold) / GOLDEN_WORDS;
+	if (ulLen == 0)
+	{
+		mexPrintf("golden: cannot read %s\n", pGoldenFile);
+		free(upGold);
+		return (0xFFFFFFFF);
+	}
+
+	GoldenReset();
+	for (n=0; n<ulLen; n++)
+	{
+		upRec = &upGold[n*GOLDEN_WORDS];
+		GoldenStep(upRec[0]);
+		for (i=1; i<GOLDEN_WORDS; i++)
+		{
+			if (uGoldenRec[i] != upRec[i])
+				break;
+		}
+		if (i == GOLDEN_WORDS)
+			continue;
+
+		if (ulBad == 0)
+			ulFirst = n;
+		if (ulBad < GOLDEN_REPORT)
+		{
+			mexPrintf("golden: sample %lu %s expected %u got %u\n", (unsigned long)n,
+				cpWordName[i], upRec[i], uGoldenRec[i]);
+		}
+		ulBad++;
+	}
+	free(upGold);
+
+	if (ulBad == 0)
+		mexPrintf("golden: %s, %lu samples bit exact\n", pGoldenFile, (unsigned long)ulLen);
+	else
+		mexPrintf("golden: %s, %lu of %lu samples differ, first at %lu\n", pGoldenFile,
+			(unsigned long)ulBad, (unsigned long)ulLen, (unsigned long)ulFirst);
+	return (ulBad);
+}
+
+
+//==========================================================================================
+// Function:		GoldenSynth()
+//
+// Description: 	Write a sample file of one clean frame of GOLDEN_SYNTH_LEN bytes:
+//					GOLDEN_SYNTH_GAP samples of silence, the FillTxBuffer() bits as
+//					phase continuous tones (1 = TX_FREQ_s, 0 = TX_FREQ_m, TX_BIT_COUNT
+//					samples per bit) at RX_Sampling, and another GOLDEN_SYNTH_GAP
+//					samples of silence.  The message is a fixed pattern, so the file
+//					only changes with the frame format.  Returns the number of samples,
+//					0 on a file error.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u32 GoldenSynth(const char *pOutFile)
+{
+	FILE	*pF;
+	double	dPhase = 0.0;
+	u32		ulLen = 0;
+	u16		uBit, i, n;
+
+	pF = fopen(pOutFile, "w");
+	if (pF == 0)
+		return (0);
+
+	for (i=0; i<GOLDEN_SYNTH_LEN; i++)
+		txUserDataArray[i] = (i * 37 + 11) & 0xFF;
+	FillTxBuffer(GOLDEN_SYNTH_LEN);
+
+	for (n=0; n<GOLDEN_SYNTH_GAP; n++, ulLen++)
+		fprintf(pF, "0\n");
+	for (i=0; i<uTxMsgLen; i++)
+	{
+		uBit = (txDataArray[i/16] >> (15 - (i & 15))) & 1;
+		for (n=0; n<TX_BIT_COUNT; n++, ulLen++)
+		{
+			fprintf(pF, "%d\n", (int)floor(GOLDEN_SYNTH_AMP * sin(dPhase) + 0.5));
+			dPhase += 2.0 * GOLDEN_PI * (uBit ? TX_FREQ_s : TX_FREQ_m) / RX_Sampling;
+			if (dPhase > 2.0 * GOLDEN_PI)
+				dPhase -= 2.0 * GOLDEN_PI;
+		}
+	}
+	for (n=0; n<GOLDEN_SYNTH_GAP; n++, ulLen++)
+		fprintf(pF, "0\n");
+	fclose(pF);
+
+	mexPrintf("golden: %lu samples of a %u byte frame written to %s\n", (unsigned long)ulLen,
+		GOLDEN_SYNTH_LEN, pOutFile);
+	return (ulLen);
+}
+
+#endif	// MEX_COMPILE
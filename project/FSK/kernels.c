@@ -0,0 +1,352 @@
+//==========================================================================================
+// Filename:		kernels.c
+//
+// Description:		C versions of the subs.asm kernels.
+//
+//					Each kernel has a C reference with the same rounding and saturation
+//					as the assembly, and where it pays a version written with the C28x
+//					compiler intrinsics (__max, __min, __lmax, __lmin):
+//
+//						subs.asm			C reference				intrinsics
+//						Sat16()				Sat16C()				Sat16I()
+//						SmoothADCResults()	SmoothADCResultsC()		SmoothADCResultsI()
+//						ReadProg()			ReadProgC()				-
+//						WriteProg()			WriteProgC()			-
+//
+//					KERNEL_IMPL in main.h selects which one the firmware calls.  The host
+//					build (MEX_COMPILE) always uses the C reference, with the intrinsics
+//					defined as plain C so the intrinsic versions build and can be checked
+//					there too.  There is no intrinsic for RPT, so the sums are plain loops
+//					and the compiler picks the repeat form.
+//
+//					The F2808 has one memory map for program and data, so PREAD/PWRITE on
+//					a 16-bit address reach the same word as a data pointer.  On the host
+//					ReadProgC()/WriteProgC() use a 64K word array.
+//
+//					KernelCheck() runs every version over fixed edge cases and a
+//					pseudo-random sequence, counts the results that differ from the C
+//					reference and measures the CPU cycles per call (CMD_KERNEL_CHECK).
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Cycles from the free-running counter.
+//==========================================================================================
+
+#include "main.h"
+
+#define	RAMFUNCS_KERNELS						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+//---- the assembly versions, by their own names ------------------------
+#ifdef DSP_COMPILE
+	#undef	Sat16
+	#undef	SmoothADCResults
+	#undef	ReadProg
+	#undef	WriteProg
+	extern q16	Sat16(q32 qlX);
+	extern u16	SmoothADCResults(void);
+	extern u16	ReadProg(u16 Address);
+	extern void	WriteProg(u16 Address, u16 Data);
+#endif
+
+//---- C28x intrinsics as plain C for the host build --------------------
+#ifdef MEX_COMPILE
+	#define	__max(A,B)		Max(A,B)
+	#define	__min(A,B)		Min(A,B)
+	#define	__lmax(A,B)		Max(A,B)
+	#define	__lmin(A,B)		Min(A,B)
+#endif
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	KERNEL_RANDOM		256			// pseudo-random inputs per kernel
+#define	KERNEL_TIMED		64			// calls per cycle measurement
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+#ifdef MEX_COMPILE
+static u16		uProgSpace[0x10000];	// program space of the host build
+#endif
+static u32		ulKernelSeed = 1;
+
+
+//==========================================================================================
+// Function:		Sat16C(), Sat16I()
+//
+// Description: 	Saturate a value to +/-32767, like Sat16() in subs.asm.
+//
+// Revision History:
+// 19Oct26			New functions.
+//==========================================================================================
+q16 Sat16C(q32 qlX)
+{
+	if (qlX > 32767)
+		return (32767);
+	if (qlX < -32767)
+		return (-32767);
+	return ((q16)qlX);
+}
+
+q16 Sat16I(q32 qlX)
+{
+	return ((q16)__lmin(__lmax(qlX, -32767L), 32767L));
+}
+
+
+//==========================================================================================
+// Function:		AdcFrontEndI()
+//
+// Description: 	AdcFrontEnd() with the minimum and maximum taken by intrinsics.
+//					The median has nothing to gain and goes to AdcFrontEnd().
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static s16 AdcFrontEndI(const volatile u16 *upResult)
+{
+#if (ADC_FRONT_MODE == ADC_FRONT_MEDIAN)
+	return (AdcFrontEnd((const u16 *)upResult));
+#else
+	s16		sSample;
+	s16		sHigh = -32767-1;
+	s16		sLow = 32767;
+	s32		lSum = 0;
+	u16		i;
+
+	for (i=0; i<OVERSAMPLE_RATE; i++)
+	{
+		sSample = (s16)(upResult[i] - 0x8000U);
+		sHigh = __max(sHigh, sSample);
+		sLow = __min(sLow, sSample);
+		lSum += sSample;
+	}
+
+	#if (ADC_FRONT_MODE == ADC_FRONT_TRIM)
+		lSum = lSum - sHigh - sLow;
+	#endif
+
+	return ((s16)((lSum * ADC_FRONT_RECIP) >> ADC_FRONT_RECIP_SCALE));
+#endif
+}
+
+
+//==========================================================================================
+// Function:		SmoothADCResultsC(), SmoothADCResultsI()
+//
+// Description: 	Combine the ADC results of one receive sample, like SmoothADCResults()
+//					in subs.asm.
+//
+// Revision History:
+// 19Oct26			New functions.
+//==========================================================================================
+u16 SmoothADCResultsC(void)
+{
+	return ((u16)AdcFrontEnd((const u16 *)&AdcRegs.ADCRESULT0));
+}
+
+u16 SmoothADCResultsI(void)
+{
+	return ((u16)AdcFrontEndI(&AdcRegs.ADCRESULT0));
+}
+
+
+//==========================================================================================
+// Function:		ReadProgC(), WriteProgC()
+//
+// Description: 	Read or write one word of program space, like ReadProg() and
+//					WriteProg() in subs.asm.
+//
+// Revision History:
+// 19Oct26			New functions.
+//==========================================================================================
+u16 ReadProgC(u16 Address)
+{
+#ifdef MEX_COMPILE
+	return (uProgSpace[Address & 0xFFFF]);
+#else
+	return (*(volatile u16 *)(u32)Address);
+#endif
+}
+
+void WriteProgC(u16 Address, u16 Data)
+{
+#ifdef MEX_COMPILE
+	uProgSpace[Address & 0xFFFF] = Data & 0xFFFF;
+#else
+	*(volatile u16 *)(u32)Address = Data;
+#endif
+}
+
+
+//==========================================================================================
+// Function:		KernelRandom()
+//
+// Description: 	Pseudo-random 32-bit value (LCG), the same sequence on host and target.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u32 KernelRandom(void)
+{
+	ulKernelSeed = ulKernelSeed * 1664525UL + 1013904223UL;
+	return (ulKernelSeed & 0xFFFFFFFFUL);
+}
+
+
+//==========================================================================================
+// Function:		KernelCycles()
+//
+// Description: 	CPU cycles per call from ulStart (CYCLE_COUNT()) to now.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Free-running CpuTimer1 instead of CpuTimer0, which reloads every
+//					timer tick and so wrapped more than once in a timed loop.
+//==========================================================================================
+static u16 KernelCycles(u32 ulStart)
+{
+	u32		ulCycles;
+
+	ulCycles = CYCLE_COUNT() - ulStart;
+	return ((u16)Min(ulCycles / KERNEL_TIMED, 0xFFFF));
+}
+
+
+//==========================================================================================
+// Function:		KernelCheck()
+//
+// Description: 	Cross-check the kernel versions against the C reference.  Fills
+//					upResult[KERNEL_CHECK_LEN]:
+//						0	Sat16 results that differ
+//						1	SmoothADCResults results that differ
+//						2	ReadProg / WriteProg words that differ
+//						3	Sat16 C reference, cycles per call
+//						4	Sat16 intrinsics, cycles per call
+//						5	Sat16 assembly, cycles per call (0 on the host)
+//						6	SmoothADCResults C reference, cycles per call
+//						7	SmoothADCResults intrinsics, cycles per call
+//						8	SmoothADCResults assembly, cycles per call (0 on the host)
+//					Returns the total number of differences.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 KernelCheck(u16 *upResult)
+{
+	static const q32 qlEdge[] = {0, 1, -1, 32766, 32767, 32768, -32766, -32767, -32768,
+		-32769, 65535, -65536, 0x7FFFFFFFL, -0x7FFFFFFFL, -0x7FFFFFFFL-1};
+	u16		uAdc[OVERSAMPLE_RATE];
+	q32		qlX;
+	u32		ulStart;
+	u16		uAddr;
+	u16		uWord;
+	u16		i, n;
+
+	volatile q16	qSink;
+	#ifdef DSP_COMPILE
+	static u16	uScratch = 0;			// program space word for the ReadProg/WriteProg check
+	#endif
+
+	for (i=0; i<KERNEL_CHECK_LEN; i++)
+		upResult[i] = 0;
+	ulKernelSeed = 1;
+
+	//---- Sat16 -------------------------------------------
+	for (n=0; n<sizeof(qlEdge)/sizeof(qlEdge[0]) + KERNEL_RANDOM; n++)
+	{
+		if (n < sizeof(qlEdge)/sizeof(qlEdge[0]))
+			qlX = qlEdge[n];
+		else
+			qlX = (q32)KernelRandom() >> (n & 15);		// all magnitudes
+		if (Sat16I(qlX) != Sat16C(qlX))
+			upResult[0]++;
+		#ifdef DSP_COMPILE
+		if (Sat16(qlX) != Sat16C(qlX))
+			upResult[0]++;
+		#endif
+	}
+
+	//---- ADC front end: random bursts through both C versions ----
+	for (n=0; n<KERNEL_RANDOM; n++)
+	{
+		for (i=0; i<OVERSAMPLE_RATE; i++)
+			uAdc[i] = (u16)(KernelRandom() >> (16 + (n & 7))) << (n & 7);
+		if (AdcFrontEndI(uAdc) != AdcFrontEnd(uAdc))
+			upResult[1]++;
+	}
+	//---- and the live ADC results through all versions ----------
+	#ifdef DSP_COMPILE
+	for (n=0; n<KERNEL_RANDOM; n++)
+	{
+		DINT;
+		if ((SmoothADCResults() != SmoothADCResultsC()) || (SmoothADCResultsI() != SmoothADCResultsC()))
+			upResult[1]++;
+		EINT;
+	}
+	#endif
+
+	//---- ReadProg / WriteProg round trips ----------------------
+	#ifdef DSP_COMPILE
+		uAddr = (u16)(u32)&uScratch;
+	#else
+		uAddr = 0x8000;
+	#endif
+	for (n=0; n<KERNEL_RANDOM; n++)
+	{
+		uWord = (u16)(KernelRandom() & 0xFFFF);
+		WriteProgC(uAddr, uWord);
+		if (ReadProgC(uAddr) != uWord)
+			upResult[2]++;
+		#ifdef DSP_COMPILE
+		if ((ReadProg(uAddr) != uWord) || (uScratch != uWord))
+			upResult[2]++;
+		WriteProg(uAddr, ~uWord);
+		if (ReadProgC(uAddr) != (u16)~uWord)
+			upResult[2]++;
+		#endif
+	}
+
+	//---- cycles per call ------------------------------------
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = Sat16C((q32)n << 10);
+	upResult[3] = KernelCycles(ulStart);
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = Sat16I((q32)n << 10);
+	upResult[4] = KernelCycles(ulStart);
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = (q16)SmoothADCResultsC();
+	upResult[6] = KernelCycles(ulStart);
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = (q16)SmoothADCResultsI();
+	upResult[7] = KernelCycles(ulStart);
+	#ifdef DSP_COMPILE
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = Sat16((q32)n << 10);
+	upResult[5] = KernelCycles(ulStart);
+	ulStart = CYCLE_COUNT();
+	for (n=0; n<KERNEL_TIMED; n++)
+		qSink = (q16)SmoothADCResults();
+	upResult[8] = KernelCycles(ulStart);
+	#endif
+	qSink = qSink;
+
+	#ifdef MEX_COMPILE
+		mexPrintf("kernels: %d Sat16, %d SmoothADCResults, %d ReadProg/WriteProg differences\n",
+			upResult[0], upResult[1], upResult[2]);
+	#endif
+
+	return (upResult[0] + upResult[1] + upResult[2]);
+}
@@ -0,0 +1,258 @@
+//==========================================================================================
+// Filename:		link.c
+//
+// Description:		Per destination link table with frame length and retry adaptation.
+//
+//					Each echo/ack round trip (CmdPLCEcho() / CmdPLCEchoAck()) is a
+//					measurement of the link to the destination.  The table keeps an
+//					average success rate and the SNR of the acks for up to LINK_TABLE_LEN
+//					destinations, and from them picks the frame length and the number of
+//					retries used for traffic to that destination.  Good links run long
+//					frames without retries, bad links fall back to short frames with
+//					more retries.
+//
+//					The bit rate is fixed by TX_BIT_COUNT at both ends and is not adapted.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	LINK_ADDR_NONE		0xFFFF		// unused table entry
+#define	LINK_RATE_ONE		256			// uSuccess of 100% (Q8)
+#define	LINK_RATE_SHIFT		3			// success rate average over ~8 attempts
+#define	LINK_RATE_GOOD		230			// 90%: longer frames, fewer retries
+#define	LINK_RATE_BAD		179			// 70%: shorter frames, more retries
+#define	LINK_SNR_SHIFT		2			// SNR average over ~4 acks
+#define	LINK_SNR_GOOD		24			// 18 dB (rxQuality.uSnr units of 1.5 dB)
+#define	LINK_SNR_BAD		12			//  9 dB
+#define	LINK_ADAPT_EVERY	4			// attempts between adaptation steps
+
+#define	LINK_FRAME_MIN		8			// echo header (7 bytes) + 1
+#define	LINK_FRAME_STEP		8
+#define	LINK_RETRY_MAX		3
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+linkEntry	linkTable[LINK_TABLE_LEN];		// Link state per destination
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+u16		uLinkClock = 0;					// counts link results, for least recently used
+u16		uLinkAwaitAddr = LINK_ADDR_NONE;// destination of the frame waiting for an ack
+u16		uLinkRetry = 0;					// retries made for the current frame
+
+
+//==========================================================================================
+// Function:		LinkInit()
+//
+// Description: 	Empty the link table.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LinkInit(void)
+{
+	u16		i;
+
+	memset(linkTable, 0, sizeof(linkTable));
+	for (i=0; i<LINK_TABLE_LEN; i++)
+	{
+		linkTable[i].uAddr = LINK_ADDR_NONE;
+	}
+	uLinkAwaitAddr = LINK_ADDR_NONE;
+	uLinkRetry = 0;
+}
+
+
+//==========================================================================================
+// Function:		LinkFind()
+//
+// Description: 	Returns the table entry for uAddr and marks it used.  A new destination
+//					takes an unused entry, or the least recently used one, and starts with
+//					middle settings.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			A lookup marks the entry used, so active destinations stay.
+//==========================================================================================
+linkEntry *LinkFind(u16 uAddr)
+{
+	u16			i;
+	linkEntry	*pLink;
+	linkEntry	*pOldest;
+
+	pOldest = &linkTable[0];
+	for (i=0; i<LINK_TABLE_LEN; i++)
+	{
+		pLink = &linkTable[i];
+		if (pLink->uAddr == uAddr)
+		{
+			pLink->uUsed = uLinkClock;
+			return (pLink);
+		}
+
+		if (pOldest->uAddr == LINK_ADDR_NONE)
+			continue;
+		if ( (pLink->uAddr == LINK_ADDR_NONE) ||
+			 ((u16)(uLinkClock - pLink->uUsed) > (u16)(uLinkClock - pOldest->uUsed)) )
+			pOldest = pLink;
+	}
+
+	memset(pOldest, 0, sizeof(linkEntry));
+	pOldest->uAddr = uAddr;
+	pOldest->uSuccess = LINK_RATE_ONE/2 + LINK_RATE_ONE/4;
+	pOldest->uSnr = (LINK_SNR_GOOD + LINK_SNR_BAD)/2;
+	pOldest->uFrameLen = (LINK_FRAME_MIN + MAX_TX_MSG_LEN)/2;
+	pOldest->uRetries = 1;
+	pOldest->uUsed = uLinkClock;
+	return (pOldest);
+}
+
+
+//==========================================================================================
+// Function:		LinkResult()
+//
+// Description: 	Record one attempt to reach pLink and adapt the frame length and
+//					retry count every LINK_ADAPT_EVERY attempts.
+//					uSnr is only used for successful attempts.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LinkResult(linkEntry *pLink, u16 uOk, u16 uSnr)
+{
+	s16		sDelta;
+
+	uLinkClock++;
+	pLink->uUsed = uLinkClock;
+
+	//---- update the averages ----------------------------
+	sDelta = (uOk ? LINK_RATE_ONE : 0) - (s16)pLink->uSuccess;
+	pLink->uSuccess += sDelta >> LINK_RATE_SHIFT;
+	if (uOk)
+	{
+		pLink->uAcked++;
+		sDelta = (s16)uSnr - (s16)pLink->uSnr;
+		pLink->uSnr += sDelta >> LINK_SNR_SHIFT;
+	}
+
+	//---- adapt ------------------------------------------
+	if (++pLink->uAdaptCnt < LINK_ADAPT_EVERY)
+		return;
+	pLink->uAdaptCnt = 0;
+
+	if ( (pLink->uSuccess < LINK_RATE_BAD) || (pLink->uSnr < LINK_SNR_BAD) )
+	{
+		if (pLink->uFrameLen > LINK_FRAME_MIN)
+			pLink->uFrameLen -= LINK_FRAME_STEP;
+		if (pLink->uRetries < LINK_RETRY_MAX)
+			pLink->uRetries++;
+	}
+	else if ( (pLink->uSuccess >= LINK_RATE_GOOD) && (pLink->uSnr >= LINK_SNR_GOOD) )
+	{
+		if (pLink->uFrameLen < MAX_TX_MSG_LEN)
+			pLink->uFrameLen += LINK_FRAME_STEP;
+		if (pLink->uRetries > 0)
+			pLink->uRetries--;
+	}
+	pLink->uFrameLen = Saturate(pLink->uFrameLen, LINK_FRAME_MIN, MAX_TX_MSG_LEN);
+}
+
+
+//==========================================================================================
+// Function:		LinkTxSent()
+//
+// Description: 	A frame that expects an ack has been queued for uAddr.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LinkTxSent(u16 uAddr)
+{
+	LinkFind(uAddr)->uSent++;
+	uLinkAwaitAddr = uAddr;
+}
+
+
+//==========================================================================================
+// Function:		LinkAck()
+//
+// Description: 	An ack arrived from uAddr.  uOk is False if it carried an error code.
+//					rxQuality still holds the quality of the ack packet, which stands in
+//					for the forward link (the power line is close to reciprocal).
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LinkAck(u16 uAddr, u16 uOk)
+{
+	if (uAddr != uLinkAwaitAddr)
+		return;							// late or unexpected ack
+
+	LinkResult(LinkFind(uAddr), uOk, rxQuality.uSnr);
+	uLinkAwaitAddr = LINK_ADDR_NONE;
+	uLinkRetry = 0;
+}
+
+
+//==========================================================================================
+// Function:		LinkTimeout()
+//
+// Description: 	Called before the next frame would be sent.  If the last frame is
+//					still waiting for its ack it has failed.  Returns True if it should
+//					be sent again, False if a new frame may be sent.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 LinkTimeout(void)
+{
+	linkEntry	*pLink;
+
+	if (uLinkAwaitAddr == LINK_ADDR_NONE)
+		return (False);
+
+	pLink = LinkFind(uLinkAwaitAddr);
+	LinkResult(pLink, False, 0);
+	uLinkAwaitAddr = LINK_ADDR_NONE;
+
+	if (uLinkRetry < pLink->uRetries)
+	{
+		uLinkRetry++;
+		pLink->uRetried++;
+		return (True);
+	}
+
+	pLink->uDropped++;
+	uLinkRetry = 0;
+	return (False);
+}
+
+
+//==========================================================================================
+// Function:		LinkFrameLen()
+//
+// Description: 	Frame length (bytes) to use for bulk traffic to uAddr.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 LinkFrameLen(u16 uAddr)
+{
+	return (LinkFind(uAddr)->uFrameLen);
+}
@@ -0,0 +1,159 @@
+//==========================================================================================
+// Filename:		load.c
+//
+// Description:		CPU load meter.
+//
+//					CpuTimer1 runs free at SYSCLKOUT as a 32-bit cycle counter
+//					(CYCLE_COUNT() in main.h).  adc_isr() adds its own time to
+//					LOAD_ISR, SchedRun() adds the time of each task to LOAD_TASK + its
+//					index in schedTable[], and MainLoop() adds the time it waits in IDLE
+//					to LOAD_IDLE.  MainLoop() runs with interrupts disabled, so every
+//					interrupt falls in the IDLE wait and its time is taken off LOAD_IDLE
+//					again.  LOAD_LOOP is what is left: the scheduler itself, the loop and
+//					the timer interrupt.
+//
+//					Once a second LoadTick() turns the cycles of each bucket into a load
+//					in 0.1 % units and keeps the last, lowest, average and highest value
+//					since LoadReset() (CMD_LOAD_STATS).  The ISR also keeps its longest
+//					single run, the number that decides whether the next sample is late.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+#define	RAMFUNCS_LOAD						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	LOAD_SECOND			((u32)DSP_FREQ)		// cycles per measurement interval
+#define	LOAD_FULL			1000				// load units at 100 %
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u32		ulLoadCycles[LOAD_BUCKETS];			// Cycles per bucket in the current second
+u16		uLoadStats[LOAD_BUCKETS][LOAD_STAT_WORDS];	// Last, min, avg, max per bucket, 0.1 %
+u16		uLoadIsrMax = 0;					// Longest single adc_isr() run, CPU cycles
+u16		uLoadSeconds = 0;					// Seconds measured since LoadReset()
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static u32		ulLoadStart = 0;			// CYCLE_COUNT() at the start of the second
+static u32		ulLoadSum[LOAD_BUCKETS];	// sum of the loads, for the average
+
+
+//==========================================================================================
+// Function:		LoadInit()
+//
+// Description: 	Start CpuTimer1 as a free-running cycle counter and clear the meter.
+//					CpuTimer1 is left to DSP BIOS in the TI examples; this firmware
+//					runs without BIOS.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LoadInit(void)
+{
+	StopCpuTimer1();
+	CpuTimer1Regs.PRD.all = 0xFFFFFFFF;		// full 32-bit range
+	CpuTimer1Regs.TPR.all = 0;				// divide by 1 (SYSCLKOUT)
+	CpuTimer1Regs.TPRH.all = 0;
+	CpuTimer1Regs.TCR.bit.TIE = 0;			// no interrupt
+	CpuTimer1Regs.TCR.bit.SOFT = 1;
+	CpuTimer1Regs.TCR.bit.FREE = 1;			// keep counting at a breakpoint
+	ReloadCpuTimer1();						// TIM = PRD before the first count
+	StartCpuTimer1();
+
+	LoadReset();
+}
+
+
+//==========================================================================================
+// Function:		LoadReset()
+//
+// Description: 	Clear the statistics and start a new second.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LoadReset(void)
+{
+	memset(ulLoadCycles, 0, sizeof(ulLoadCycles));
+	memset(ulLoadSum, 0, sizeof(ulLoadSum));
+	memset(uLoadStats, 0, sizeof(uLoadStats));
+	uLoadIsrMax = 0;
+	uLoadSeconds = 0;
+	ulLoadStart = CYCLE_COUNT();
+}
+
+
+//==========================================================================================
+// Function:		LoadTick()
+//
+// Description: 	Called by MainLoop() once per receive sample.  At the end of each
+//					second, turn the cycles into loads and update the statistics.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void LoadTick(void)
+{
+	u32		ulNow;
+	u32		ulUnit;					// cycles per load unit
+	u32		ulUsed;
+	u16		uLoad;
+	u16		uSumming;				// Flag: add this second to the average
+	u16		i;
+
+	ulNow = CYCLE_COUNT();
+	if (ulNow - ulLoadStart < LOAD_SECOND)
+		return;
+
+	ulUnit = (ulNow - ulLoadStart) / LOAD_FULL;
+	ulLoadStart = ulNow;
+
+	// interrupts only run in the IDLE wait
+	if (ulLoadCycles[LOAD_IDLE] > ulLoadCycles[LOAD_ISR])
+		ulLoadCycles[LOAD_IDLE] -= ulLoadCycles[LOAD_ISR];
+	else
+		ulLoadCycles[LOAD_IDLE] = 0;
+
+	ulUsed = 0;
+	for (i=0; i<LOAD_BUCKETS; i++)
+	{
+		if (i != LOAD_LOOP)
+			ulUsed += ulLoadCycles[i];
+	}
+	ulLoadCycles[LOAD_LOOP] = (ulUnit * LOAD_FULL > ulUsed) ? (ulUnit * LOAD_FULL - ulUsed) : 0;
+
+	uSumming = (uLoadSeconds < 0xFFFF);		// the average stops after 18 hours
+	if (uSumming)
+		uLoadSeconds++;
+	for (i=0; i<LOAD_BUCKETS; i++)
+	{
+		uLoad = (u16)Min(ulLoadCycles[i] / ulUnit, LOAD_FULL);
+		ulLoadCycles[i] = 0;
+		if (uSumming)
+			ulLoadSum[i] += uLoad;
+
+		uLoadStats[i][LOAD_LAST] = uLoad;
+		if ((uLoadSeconds == 1) || (uLoad < uLoadStats[i][LOAD_MIN]))
+			uLoadStats[i][LOAD_MIN] = uLoad;
+		if (uLoad > uLoadStats[i][LOAD_MAX])
+			uLoadStats[i][LOAD_MAX] = uLoad;
+		uLoadStats[i][LOAD_AVG] = (u16)(ulLoadSum[i] / uLoadSeconds);
+	}
+}
@@ -16,6 +16,10 @@
 // 06/21/02 EGO		Removed vardefs.h.  Function now performed by call to InitializeGlobals().
 // 10/15/02 HEM		Changed from timer2 to timer0.
 // 02/07/03 HEM/KKN Added BootCopy routine.
+// 19Oct26			MainLoop() tasks run by the scheduler (sched.c).
+// 19Oct26			Task registration in MainTasks(), built on the host too for bench.c.
+// 19Oct26			CPU load meter (load.c).
+// 19Oct26			Boot phase times.
 //==========================================================================================
 
 #include "main.h"          
@@ -26,6 +30,7 @@ interrupt void T1PINT_ISR(void);
 interrupt void adc_isr(void);
  
 #define	FLOOD_SEED_SHIFT	16					// Flood message interval shift (power of 2)
+#define	MAIN_TASK_PERIOD	8					// Samples between runs of the periodic tasks
 #define PWM1_INT_ENABLE  1
 
 u32 ulLampTimeStamp = 0;	
@@ -35,23 +40,20 @@ u16 iINPUT_B10;
 u16 iINPUT_B9;
 s16 wait_for_address = 0;
 u16 BackTicker = 0;
+static u16 uNextTxLen = COMMAND_PARMS;		// Length of the frame TaskTxStart() sends next
+
+// Global variables declared in main.h
+u32 ulBootStamp[BOOT_PHASES];				// CYCLE_COUNT() at the end of each boot phase
 
 
 
 	
 	
+#define	RAMFUNCS_MAIN						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
 #ifdef _Release
-	// Functions that will be run from RAM need to be assigned to 
-	// a different section.  This section will then be mapped using
-	// the linker cmd file.
-	#ifdef __cplusplus			// "C++"
-	#pragma CODE_SECTION("ramfuncs"); 
-	#else						// "C"
-	#pragma CODE_SECTION(ISRTimer0, "ramfuncs");
-	#pragma CODE_SECTION(MainLoop, "ramfuncs");
-	#endif
-	
-	
 	//==========================================================================================
 	// Function:		BootCopy()
 	//
@@ -62,21 +64,28 @@ u16 BackTicker = 0;
 	// Revision History:
 	// 02/07/03	KKN		Started function.  FAR statements needed if using SMALL MEMORY model, otherwise
 	//					pointer values get truncated to 16-bit.
+	// 19Oct26			Copy the length of the ramfuncs section (linker symbols) instead of
+	//					a fixed 0x800 32-bit values.
+	// 19Oct26			Source and destination from the linker symbols too, instead of the
+	//					fixed 0x3F4000 / 0x3F8000.
 	//==========================================================================================
 	void BootCopy(void)
 	{
-		// Information on the location of functions that are going
-		// to be relocated to RAM
-		#define RAM_FUNC_LOAD   0x3F4000    // Source location in Flash
-		#define RAM_FUNC_LENGTH 0x000800    // Number of 32-bit values to copy
-		#define RAM_FUNC_RUN    0x3F8000    // Destination location in RAM
+		// Section limits set by the linker cmd file.  Declared far so that their addresses
+		// keep all 22 bits in the SMALL MEMORY model.
+		extern far Uint16	RamfuncsLoadStart;
+		extern far Uint16	RamfuncsLoadEnd;
+		extern far Uint16	RamfuncsRunStart;
 		
 		Uint32  far *pSourceAddr;
 	    Uint32  far *pDestAddr;
 	    Uint16 i; 
-		pSourceAddr = (Uint32 far *)RAM_FUNC_LOAD;
-		pDestAddr = (Uint32 far *)RAM_FUNC_RUN;
-		for(i = 0; i < RAM_FUNC_LENGTH; i++)
+	    Uint16 uLength;					// Number of 32-bit values to copy
+	    
+	    uLength = (Uint16)(((Uint32)&RamfuncsLoadEnd - (Uint32)&RamfuncsLoadStart + 1) / 2);
+		pSourceAddr = (Uint32 far *)&RamfuncsLoadStart;
+		pDestAddr = (Uint32 far *)&RamfuncsRunStart;
+		for(i = 0; i < uLength; i++)
 		{
 		    *pDestAddr++ = *pSourceAddr++;
 		}
@@ -105,6 +114,7 @@ inline u32	ElapsedTime(u32 ulStopTime, u32 ulStartTime)
 }
 
 
+#ifndef MEX_COMPILE
 //==========================================================================================
 // Function:		ISRTimer0()
 //
@@ -139,6 +149,14 @@ interrupt void ISRTimer0(void)
 // 10/09/04	HEM		Break MainLoop() into its own function so we can execute it from RAM
 //					for best speed.  We cannot move main() to RAM because main() needs to 
 //					call the BootCopy before anything can execute from RAM.
+// 19Oct26			Initialize the link table.
+// 19Oct26			Initialize reliable delivery.
+// 19Oct26			Build the FEC tables.
+// 19Oct26			Initialize the repeater.
+// 19Oct26			Start the load meter.
+// 19Oct26			The CRC table is a constant table, no InitCRCtable().
+// 19Oct26			Boot phase times (CMD_BOOT_TIMES).  The ADC reference settles while
+//					the rest is initialized.  No address wait in the release build.
 //==========================================================================================
 #ifdef __cplusplus
 int main(void)
@@ -153,6 +171,7 @@ void main(void)
 
 	// Initialize System Control registers, PLL, WatchDog, Clocks to default state:
 	InitSysCtrl();
+	LoadInit();				// Free-running cycle counter: load meter and boot phase times
 
 	// Select GPIO for the device or for the specific application:
 	InitGpio();
@@ -161,15 +180,23 @@ void main(void)
 	// pointers to the shell Interrupt Service Routines (ISR)functions found in DSP28_DefaultIsr.c.
 	InitPieCtrl();			// Initialize PIE control registers
 	InitPieVectTable();		// Populate the PIE vector table with default pointers
+	BOOT_STAMP(BOOT_PIE);
 
+	// Start the ADC reference now.  Its 5 ms settling time runs while the rest is set up
+	// and PowerUpADCs() waits only for what is left of it.
+	ConfigureADCs();
+	BOOT_STAMP(BOOT_ADC_START);
 
 #ifdef _Release		// Initialize FLASH on Release version of code
 	BootCopy();		// Copy the InitFlash routine to RAM
 	InitFlash();	// Set up flash waitstates (This function >MUST< reside in RAM)
 #endif
+	BOOT_STAMP(BOOT_FLASH);
 
-	
-	InitCRCtable();	// Initialize the CRC table
+	#if FEC_ENABLE == True
+		FecInit();	// Build the Reed-Solomon tables
+	#endif
+	BOOT_STAMP(BOOT_TABLES);
 
 	// Initialize all peripherals (EV's, ADC, SPI, SCI's, CAN, McBSP, CPU Timer and XIntf) to default settings
 	#if  DSP_TYPE == 2812
@@ -177,15 +204,12 @@ void main(void)
 	#endif 
 	InitCpuTimers(); 
 	InitSci(); 
-	ConfigureADCs();
-	NOP;
-	
-	ConfigureGPTimers();	// Sets up GP timers for the PWM and ADC
-//	ConfigurePWMDAC();		// Configures the PWM D/A converters
+	BOOT_STAMP(BOOT_PERIPH);
 
 	// Software initialization
  	InitializeGlobals();	// Global variable initialization.
 	InitializeUARTArray();	// Clear out array of data to be sent to UART.
+	BOOT_STAMP(BOOT_GLOBALS);
 	
 	iINPUT_B9 = 1;
 	iINPUT_B10 = 0;
@@ -194,21 +218,34 @@ void main(void)
 // set address for the old boards
 // for new boards this will be removed
 
+#if ADDRESS_WAIT == True
    while ((wait_for_address - 1) < 0)
     { 
       BackTicker++;
     }
+#endif
     
 	uMyAddress =  0x0100 |	(iINPUT_B9 << 1) | (iINPUT_B10<<0); // Hardcoding the board address
 	
 //  Uncomment this after receiving the new board
 //	uMyAddress =  0x0100 |	(INPUT_B9 << 1) | (INPUT_B10<<0);	// Set my address based on GPIO jumper settings
 	//                       ^ OPT2 Jumper     ^ OPT1 Jumper
+	BOOT_STAMP(BOOT_ADDRESS);
 	
 	reset_to_BitSync();		// reset digital PLL states
 
 	
 	InitLampVars();			// 
+	LinkInit();				// Empty the link table
+	ArqInit();				// Empty the reliable delivery windows
+	RelayInit();			// Empty the repeater duplicate table
+	BOOT_STAMP(BOOT_NET);
+
+	PowerUpADCs();			// Power up the ADC once the reference has settled
+	BOOT_STAMP(BOOT_ADC_READY);
+
+	ConfigureGPTimers();	// Sets up GP timers for the PWM and ADC
+//	ConfigurePWMDAC();		// Configures the PWM D/A converters
 	
 	// Configure DSP Timer 0 to drive the periodic interrupt loop
 	// 		Set Up For 0.5 millisecond Interrupt Period
@@ -249,12 +286,159 @@ void main(void)
 	ERTM;			// Enable Global realtime interrupt DBGM
 
 	reset_to_BitSync();
+	BOOT_STAMP(BOOT_INTS);
+	LoadReset();			// The load meter starts with the loop, not with the boot
 
 	
 	// The setup of the system is complete at this point.  This loop replaces BIOS.
 	
 	MainLoop();		// MainLoop runs forever
 }
+#endif	// MEX_COMPILE
+
+
+//==========================================================================================
+// Function:		MainLoop() tasks
+//
+// Description: 	The tasks MainLoop() hands to the scheduler (sched.c), each with its
+//					ready function.  Frames queued by a task are sent by TaskTxStart()
+//					with the length left in uNextTxLen.
+//					TaskUart() and TaskLamp() are global so that bench.c can look up
+//					their periods in schedTable[].
+//
+// Revision History:
+// 19Oct26			New functions, from the task switcher cases of MainLoop().
+//==========================================================================================
+static u16 TaskRxReady(void)
+{
+	return (uRxMsgPending ? True : False);
+}
+
+static void TaskRx(void)
+{
+	ProcessRxPlcMsg();
+}
+
+static u16 TaskTxStartReady(void)
+{
+	// Send the pending transmit packet if there is no incoming packet in progress
+	if ((uRxMode == FIND_BITSYNC) && uTxMsgPending && (plcMode != TX_MODE) && ZcTxWindowOpen())
+		return (True);
+	return (False);
+}
+
+static void TaskTxStart(void)
+{
+	FillTxBuffer(uNextTxLen);
+	uTxMsgPending = ~True;
+}
+
+void TaskUart(void)
+{
+	HandleUART();	// Handle incoming and outgoing serial port data.
+					// Will always send and receive at least one char if they are ready
+}
+
+static u16 TaskCommandReady(void)
+{
+	// uCommandActive indicates a command is being run or is ready to start.
+	// Set by HandleUART() when a full command is ready.
+	// Cleared by command functions when the command is finished.
+	return ((uCommandActive == 1) ? True : False);
+}
+
+static void TaskCommandRun(void)
+{
+	u16		uWasPending = uTxMsgPending;	// frame already queued by TaskArq() or TaskRelay()
+
+	TaskCommand(); 	// Handle the command
+	if (uTxMsgPending && !uWasPending)		// only a frame this command queued is a command reply
+		uNextTxLen = COMMAND_PARMS;
+}
+
+#if ARQ_ENABLE == True
+static void TaskArq(void)
+{
+	u16		uArqLen;				// length of a reliable delivery frame
+
+	// Reliable delivery: run received commands in order, send acks and frames
+	uArqLen = ArqService();
+	if (uArqLen != 0)
+		uNextTxLen = uArqLen;
+}
+#endif
+
+#if RELAY_ENABLE == True
+static void TaskRelay(void)
+{
+	u16		uRelayTxLen;			// length of a relay frame
+
+	// Repeater: send a relay frame once its hold off is over
+	uRelayTxLen = RelayService();
+	if (uRelayTxLen != 0)
+		uNextTxLen = uRelayTxLen;
+}
+#endif
+
+static u16 TaskFloodReady(void)
+{
+	if ( (plcMode != TX_MODE) && 
+		 (uTxMsgPending != True) &&
+		 (uFloodInterval > 0) &&
+	     (ElapsedTime(CpuTimer0.InterruptCount, ulFloodTimeStamp) >= uFloodInterval))
+	{
+		return (True);
+	}
+	return (False);
+}
+
+static void TaskFlood(void)
+{
+	//uNextTxLen = GenerateFakePLCMessage(ulTimerIntCounter>>FLOOD_SEED_SHIFT);
+	uNextTxLen = GenerateFloodPLCMessage(ulTimerIntCounter>>FLOOD_SEED_SHIFT);
+	uTxMsgPending = True;
+	ulFloodTimeStamp = CpuTimer0.InterruptCount;
+}
+
+static u16 TaskLampReady(void)
+{
+	return ((ElapsedTime(CpuTimer0.InterruptCount, ulLampTimeStamp) >= uFadeInterval) ? True : False);
+}
+
+void TaskLamp(void)
+{
+	// Control lamp intensity
+	ulLampTimeStamp = CpuTimer0.InterruptCount;
+	ControlLamp();
+}
+
+
+//==========================================================================================
+// Function:		MainTasks()
+//
+// Description: 	Hands the MainLoop() tasks to the scheduler: receive processing,
+//					transmit start and UART every sample, commands as soon as they are
+//					complete, the rest every MAIN_TASK_PERIOD samples in the slack.
+//
+// Revision History:
+// 19Oct26			New function, from MainLoop().
+//==========================================================================================
+void	MainTasks(void)
+{
+	SchedInit();
+	SchedAdd(TaskRx, TaskRxReady, 1, SCHED_URGENT);
+	SchedAdd(TaskTxStart, TaskTxStartReady, 1, SCHED_URGENT);
+	SchedAdd(TaskUart, 0, 1, SCHED_URGENT);
+	SchedAdd(TaskCommandRun, TaskCommandReady, 1, SCHED_NORMAL);
+	#if ARQ_ENABLE == True
+	SchedAdd(TaskArq, 0, MAIN_TASK_PERIOD, SCHED_NORMAL);
+	#endif
+	#if RELAY_ENABLE == True
+	SchedAdd(TaskRelay, 0, MAIN_TASK_PERIOD, SCHED_NORMAL);
+	#endif
+	SchedAdd(TaskFlood, TaskFloodReady, MAIN_TASK_PERIOD, SCHED_BACKGROUND);
+	SchedAdd(TaskLamp, TaskLampReady, MAIN_TASK_PERIOD, SCHED_BACKGROUND);
+}
 
 
 //==========================================================================================
@@ -273,111 +457,32 @@ void main(void)
 // 11/19/04	HEM		Synchronized task switcher here with ADC Int by using ADCIntCount as selector.
 //					Reduced from 25 cases down to 5.
 // 23Feb05	Hagen	changed max ADC counter from 5 to 7 and redistributed tasks
+// 19Oct26			Reliable delivery service in task 4.
+// 19Oct26			Repeater service in task 0.
+// 19Oct26			Task switcher replaced by the scheduler (sched.c): receive processing,
+//					transmit start and UART every sample, commands as soon as they are
+//					complete, the rest every MAIN_TASK_PERIOD samples in the slack.
+// 19Oct26			Tasks registered by MainTasks().
+// 19Oct26			IDLE time and the end of each second for the load meter.
 //==========================================================================================
+#ifndef MEX_COMPILE
 void	MainLoop(void)
 {	
-	u16		uTxMsgLen = COMMAND_PARMS;
-	u16		task_switch_counter = 0;
+	u32		ulIdleStart;			// CYCLE_COUNT() when the IDLE wait started
 	
+	MainTasks();
 
 	EINT;	// Enable Global interrupt INTM	
 	
 	for(;;)	// ============== T O P   O F   M A I N   L O O P =========================
 	{
-	
-		task_switch_counter++;
-		if (task_switch_counter >= 8)
-		{task_switch_counter = 0;}
-		
-		switch (task_switch_counter)
-		{
-			case 0:
-				break;
-
-			case 1:
-			{
-				HandleUART();	// Handle incoming and outgoing serial port data.
-								// Will always send and receive at least one char if they are ready
-				NOP;			// NOP is not required, but it's a good spot for a break-point during debug.
-				break;
-			}
-	
-			case 2:
-				break;
-
-			case 3:
-			{
-				// uCommandActive indicates a command is being run or is ready to start.
-				// Set by HandleUART() when a full command is ready.
-				// Cleared by command functions when the command is finished.
-				if (uCommandActive == 1)
-				{
-					TaskCommand(); 	// Handle the command
-					uTxMsgLen = COMMAND_PARMS;
-				}	
-	
-				NOP;			// NOP is not required, but it's a good spot for a break-point during debug.
-				break;
-			}
-			
-			case 4:
-				break;
-
-			case 5:
-			{
-				// Control lamp intensity
-				if (ElapsedTime(CpuTimer0.InterruptCount, ulLampTimeStamp) >= uFadeInterval)
-				{
-					ulLampTimeStamp = CpuTimer0.InterruptCount;
-					ControlLamp();
-				}
-
-			
-				NOP;			// NOP is not required, but it's a good spot for a break-point during debug.
-				break;
-			}			
-			
-			case 6:
-			{
-				if ( (plcMode != TX_MODE) && 
-					 (uTxMsgPending != True) &&
-					 (uFloodInterval > 0) &&
-				     (ElapsedTime(CpuTimer0.InterruptCount, ulFloodTimeStamp) >= uFloodInterval))
-				{
-					//uTxMsgLen = GenerateFakePLCMessage(ulTimerIntCounter>>FLOOD_SEED_SHIFT);
-					uTxMsgLen = GenerateFloodPLCMessage(ulTimerIntCounter>>FLOOD_SEED_SHIFT);
-					uTxMsgPending = True;
-					ulFloodTimeStamp = CpuTimer0.InterruptCount;
-				}
-			
-				NOP;			// NOP is not required, but it's a good spot for a break-point during debug.
-				break;
-			}
-			
-	
-			default:
-			{
-				NOP;	
-				break;
-			}
-		}
-
-
-		// Send the pending transmit packet if there is no incoming packet in progress
-		if (uRxMode == FIND_BITSYNC)
-		{
-			if (uTxMsgPending && (plcMode != TX_MODE))	
-			{
-				FillTxBuffer(uTxMsgLen);
-				uTxMsgPending = ~True;
-			}
-		}
-		
+		SchedRun();					// Run the tasks that are due and ready
 
 		uSampleNumber++;			// increment sample number for next pass.
 
 
 		// === TOP OF  IDLE LOOP ===
+		ulIdleStart = CYCLE_COUNT();
 		while (uADCIntFlag == 0)	// Wait here until ADC interrupt occurs
 		{	
 
@@ -392,18 +497,17 @@ void	MainLoop(void)
 		}
 		// === BOTTOM OF  IDLE LOOP ===
 //		SetXF();					// Debug: Toggle XF to show idle time on external scope
+		ulLoadCycles[LOAD_IDLE] += CYCLE_COUNT() - ulIdleStart;	// interrupts included, see load.c
 
 		uADCIntFlag = 0;			// Clear the ADC interrupt flag
 
-		if (uRxMsgPending)
-		{
-			ProcessRxPlcMsg();
-		}
-
 		ulTimerIntCounter++;		// Increment once per sample
 
+		LoadTick();					// Load statistics once a second
+
 	}	// ============== B O T T O M   O F   M A I N   L O O P =========================
 }
+#endif	// MEX_COMPILE
 
 
 
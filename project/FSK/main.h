@@ -40,6 +40,28 @@
 
 #define MEX_VERBOSE			False
 
+//---- low level kernels: assembly (subs.asm), C reference or C with C28x intrinsics (kernels.c)
+#define	KERNEL_ASM			0
+#define	KERNEL_C			1
+#define	KERNEL_INTRINSIC	2
+#ifdef MEX_COMPILE
+	#define	KERNEL_IMPL		KERNEL_C		// no assembly on the host
+#else
+	#define	KERNEL_IMPL		KERNEL_ASM
+#endif
+
+#if KERNEL_IMPL == KERNEL_C
+	#define	Sat16				Sat16C
+	#define	SmoothADCResults	SmoothADCResultsC
+	#define	ReadProg			ReadProgC
+	#define	WriteProg			WriteProgC
+#elif KERNEL_IMPL == KERNEL_INTRINSIC
+	#define	Sat16				Sat16I
+	#define	SmoothADCResults	SmoothADCResultsI
+	#define	ReadProg			ReadProgC		// plain C is already a single load/store
+	#define	WriteProg			WriteProgC
+#endif
+
 //---- Matlab library declarations --------------------------------
 #ifdef MEX_COMPILE
 	#ifdef LOC_OFFICE
@@ -60,6 +82,11 @@ typedef unsigned int 	u16;
 typedef unsigned long 	u32;
 typedef	s16				q16; 
 typedef	s32				q32;  
+#ifdef MEX_COMPILE
+typedef	__int64			s64;			// Visual C++
+#else
+typedef	long long		s64;
+#endif
 
 
 
@@ -72,6 +99,7 @@ typedef	s32				q32;
 //#endif
 
 #include "DSP280x_Device.h"	// DSP28 general file. device #includes, register definitions.
+#include "adcfront.h"		// receive front end configuration (shared with subs.asm)
 #include "prototypes.h"		// global prototype declarations.
 #include "error.h"			// error codes.
 #include "DSP280x_ePWM_defines.h"
@@ -96,6 +124,14 @@ typedef	s32				q32;
 	asm("TRACE_BUF_LEN .set 01A00H");
 #endif
 
+// Old boards: main() holds at boot until wait_for_address is set from the debugger.
+// A release build boots without a debugger and must not wait.
+#ifdef _Release
+	#define	ADDRESS_WAIT	False
+#else
+	#define	ADDRESS_WAIT	True
+#endif
+
 //==========================================================================================
 // Global Constants - Related to hardware. Register bits, ...
 //==========================================================================================
@@ -244,10 +280,28 @@ typedef	s32				q32;
 #define	CMD_LOCAL_ADDRESS				(0x000F)		
 
 #define	CMD_DIAG_TRACE_CONFIG			(0x0010)
+#define	CMD_READ_ZC_STATS				(0x0011)
+#define	CMD_SCAN						(0x0012)
+#define	CMD_READ_LINKS					(0x0013)
+#define	CMD_PLC_RELIABLE				(0x0014)
+#define	CMD_ARQ_STATUS					(0x0015)
+#define	CMD_PLC_RELAYED					(0x0016)
+#define	CMD_RELAY_STATUS				(0x0017)
+#define	CMD_KERNEL_CHECK				(0x0018)
+#define	CMD_LOAD_STATS					(0x0019)
+#define	CMD_BOOT_TIMES					(0x001A)
 
 #define	CMD_ECHO_SET					(0x0020)
 #define	CMD_ECHO_CMD					(0x0021)
 #define	CMD_ECHO_ACK					(0x0022)
+#define	CMD_ARQ_DATA					(0x0023)
+#define	CMD_ARQ_ACK						(0x0024)
+#define	CMD_LAMP_BATCH					(0x0025)
+#define	CMD_RELAY						(0x0026)
+
+//---- PLC destination addresses other than a node address ------------
+#define	PLC_ADDR_BROADCAST				(0xFFFF)	// every node
+#define	PLC_ADDR_GROUP					(0xFE00)	// | group number 0-15, lamps in uLampGroupFlags
 
 //==========================================================================================
 // Command parm number descriptions by command
@@ -396,13 +450,14 @@ typedef	s32				q32;
 	#define Saturate(x,LoLim,HiLim) ((x) > (HiLim) ? (HiLim) : ((x) < (LoLim) ? (LoLim) : (x)))
 
 #if (SATMACROS == True)
+	#undef	Sat16
 	#define Sat16(x) Saturate((x), -32767, 32767)
 	#define LSaturate(x,LoLim,HiLim) Max((LoLim), Min((HiLim), (x) ) )
 #else
 #ifdef __cplusplus
 extern "C"	{
 #endif
-	extern q16	Sat16(q32 qlX);			// Saturate value to +/-32767
+	extern q16	Sat16(q32 qlX);			// Saturate value to +/-32767 (subs.asm or kernels.c, see KERNEL_IMPL)
 //	extern q16	Saturate(q32 qlVal, q32 qlLoLim, q32 qlHiLim);
 	#define LSaturate(x,LoLim,HiLim) Saturate(x,LoLim,HiLim)
 #ifdef __cplusplus
@@ -534,6 +589,8 @@ typedef struct
 	s16				sigPower;
 	s16				sGainIndex;
 	s16				agcHold;
+	s32				agcSum;		// fast-attack AGC: sum of |signal| over the window
+	u16				agcCount;	// fast-attack AGC: samples in the window so far
 }	pllControl;
 
 
@@ -582,6 +639,7 @@ extern u16	upCommand[COMMAND_PARMS];		// Local copy of last command.
 extern u16	upSerialCommand[COMMAND_PARMS];	// Buffer to hold command from serial port.
 extern u16	uCommandPending;				// Signals a full command has been received.
 extern u16	uCommandActive;					// Indicates a command is being run.
+extern u16	uCommandMulticast;				// Flag: command came in a group or broadcast frame.  No reply.
 //extern u16	uCalibActive;					// Indicates calibrations are being run.
 //extern u16	uSampleRate;					// SampleRate variable for tester use.
 
@@ -623,9 +681,25 @@ extern s16		demodBuf[ADCINT_COUNT_MAX]; // receive FIR buffer
 enum {RX_MODE, TX_MODE};
 extern u16	plcMode;						// Power Line Communications mode.  TX or RX
 extern u16	plcModeSnap;					// Snapshot of Power Line Communications mode.  TX or RX.
+extern u16	uSoftBit;						// Magnitude of the last bit decision integral (soft bit)
+extern s16	sRxDemodBias;					// Demod DC bias latched at the last preamble
+extern s16	sRxFreqOffset;					// Carrier offset (Hz) estimated at the last preamble
 
 #define USE_CRC				True			// calculate, transmit and compate at receive a 16 bit CRC
 #define	RECEIVE_OWN_XMIT	True			// Enable this line to allow us to receive our own transmitted signal		
+#define	IMPULSE_BLANKER		True			// Blank receive samples far above the tracked noise floor
+#define	ZC_SYNC				False			// Start transmit frames in the quietest phase of the mains;
+											// enable once ZC_ADC_CHANNEL is wired to the mains sense
+#define	ZC_ADC_CHANNEL		7				// ADC input with the attenuated mains sense signal
+#define	NOISE_SCAN			True			// Goertzel line spectrum scanner while idle (CMD_SCAN)
+#define	LINK_ADAPT			True			// Adapt flood frame length and retries to the link (link.c)
+#define	ARQ_ENABLE			True			// Reliable command delivery with CMD_PLC_RELIABLE (arq.c)
+#define	PLC_MULTICAST		True			// Accept frames sent to a group of this lamp or to every node
+#define	RELAY_ENABLE		True			// Repeat CMD_RELAY frames for other nodes (relay.c), needs PLC_MULTICAST
+#define	LAMP_BATCH			True			// Run broadcast CMD_LAMP_BATCH frames in ProcessRxPlcMsg()
+#define	LAMP_BATCH_ENTRY_LEN	4			// address (2), CMD_LAMP_DIRECT/CMD_LAMP, value
+#define	FEC_ENABLE			False			// Reed-Solomon parity on every frame (fec.c).  Changes the
+											// frame format, so all nodes must be built the same way
 
 //enum {FIND_BITSYNC1, FIND_BITSYNC2, FIND_ZEROCROSS, FIND_WORDSYNC, FIND_DATA};
 enum {FIND_BITSYNC, FIND_WORDSYNC, FIND_DATA, FIND_EOP, EOP_HOLD_OFF};
@@ -633,7 +707,18 @@ extern u16	uRxMode;						// PLC Receive Mode
 
 extern u16		uRxByteCount;				// pointer to rxUserDataArray
 
-#define	MAX_RX_MSG_LEN	36					// Maximum receive message length (bytes)
+//---- forward error correction (fec.c) ----------------------------
+#define	FEC_NROOTS		4					// parity bytes per block: 2 errors or 4 erasures
+#define	FEC_DEPTH		2					// interleaved blocks per frame
+#define	FEC_FAIL		0xFFFF				// FecDecodeRx() result for an uncorrectable frame
+#if FEC_ENABLE == True
+	#define	FEC_PARITY_LEN	(FEC_NROOTS*FEC_DEPTH)	// parity bytes per frame
+#else
+	#define	FEC_PARITY_LEN	0
+#endif
+extern u32	ulFecCycles;					// CPU cycles of the last FEC decode
+
+#define	MAX_RX_MSG_LEN	(36 + FEC_PARITY_LEN)	// Maximum receive message length (bytes)
 extern u16	rxUserDataArray[MAX_RX_MSG_LEN];// byte-wide buffer for user data
 
 #define	MAX_TX_MSG_LEN	32					// Maximum transmit message length (bytes)
@@ -643,11 +728,16 @@ extern u16	txUserDataArray[MAX_TX_MSG_LEN];// byte-wide buffer for user data
 #define	HEADER_LEN		(24+11)
 #define	TRAILER_LEN		(11*2)
 #define	CRCF_LEN			(11*2)
-#define	TX_ARRAY_LEN	((HEADER_LEN + MAX_TX_MSG_LEN*11 + CRCF_LEN + TRAILER_LEN + 15)/16)	
+#define	TX_ARRAY_LEN	((HEADER_LEN + MAX_TX_MSG_LEN*11 + CRCF_LEN + FEC_PARITY_LEN*11 + TRAILER_LEN + 15)/16)	
+#define	CODEWORD_BITS	11						// bits on the air per byte
+#define	PLC_FRAME_BITS(len)		(HEADER_LEN + ((len) + FEC_PARITY_LEN)*CODEWORD_BITS + CRCF_LEN + TRAILER_LEN)
+#define	PLC_TICKS_PER_BIT_Q8	((u32)(TX_BIT_COUNT * TINTS_PER_SEC * 256.0 / RX_Sampling + 0.5))
+#define	PLC_FRAME_TICKS(len)	((((u32)PLC_FRAME_BITS(len) * PLC_TICKS_PER_BIT_Q8) >> 8) + 1)	// airtime, CpuTimer0 ticks
 extern u16	txDataArray[TX_ARRAY_LEN]; 			// word-wide byte-packed buffer for user transmit data, including headers, trailers, parity, and start/stop bits
+extern u16	uTxMsgLen;							// Bits in the frame being sent
+extern u16	uTxBitNum;							// Next bit of the frame to send
 
-#define	RX_ARRAY_LEN	TX_ARRAY_LEN			// Make rx array same length as tx array.  Really could be shorter, since much of header is not stored
-extern u16	rxDataArray[RX_ARRAY_LEN];			// word-wide byte-packed buffer for user receive data, including headers, trailers, parity, and start/stop bits
+extern const u16	uTxPrecodeTable[256];		// Codeword (top 11 bits) with parity for each byte
 
 //---- define constants and buffer for debug counters -------------------
 #define PLC_STATS_LEN	(16*2*2)
@@ -664,7 +754,11 @@ enum {
  	RX_EOP_TIMEOUT,			// 8
  	RX_MSGLEN_ERROR,		// 9
 	RX_ERR_CRC, 			// 10
-	RX_ERR_PARITY 			// 11
+	RX_ERR_PARITY, 			// 11
+	RX_BLANKED,				// 12	receive samples removed by the impulse blanker
+	RX_BLANK_BURSTS,		// 13	impulses (runs of blanked samples)
+	RX_FEC_CORRECTED,		// 14	bytes repaired by the FEC decoder
+	RX_FEC_FAIL				// 15	frames the FEC decoder could not repair
 	};
 
 extern	u32	ulPlcStats[PLC_STATS_LEN/2/2][2];		// Statistics for PLC communication
@@ -679,6 +773,205 @@ enum {
 	};
 extern	u32	ulBerStats[BER_STATS_LEN/2];			// Statistics for BER testing
 
+//---- mains zero-crossing sync (mains.c) ---------------------------
+#define	ZC_PHASE_BINS		8				// phase bins per mains half cycle
+#define	ZC_TX_BINS			2				// phase bins of the transmit window (1 - ZC_PHASE_BINS)
+enum {
+	ZC_RX_GOOD,				// 0	packets received with good CRC
+	ZC_RX_ERR				// 1	CRC errors and timeouts after a preamble
+	};
+#define	ZC_STATS_LEN		(ZC_PHASE_BINS*3*2)
+extern	u32	ulZcNoise[ZC_PHASE_BINS];				// Blanked samples per mains phase bin
+extern	u32	ulZcStats[ZC_PHASE_BINS][2];			// Receive results per mains phase bin
+extern	u16	uZcPeriod;								// Samples per mains cycle, 0 = no mains sync
+extern	u16	uZcBin;									// Current phase bin within the mains half cycle
+extern	u16	uZcTxBin;								// First phase bin of the transmit window
+extern	u16	uZcRxBin;								// Phase bin of the last preamble detection
+
+//---- receive link quality per packet (dataDet_new.c) -------------
+typedef struct
+{
+	u16				uRssi;			// demod swing at the preamble, 1.5 dB steps
+	u16				uSnr;			// soft bit mean^2/variance over the data, 1.5 dB steps
+	u16				uTimingErr;		// |demod| at the bit transitions / half swing, Q4
+	u16				uBitErrs;		// codewords with parity errors
+	s16				sFreqOffset;	// carrier offset (Hz) estimated at the preamble
+}	rxQualityType;
+
+enum {
+	QUAL_RSSI,				// 0	uRssi, 3 dB bins
+	QUAL_SNR,				// 1	uSnr, 3 dB bins
+	QUAL_TIMING,			// 2	uTimingErr, Q4 bins
+	QUAL_BITERR				// 3	uBitErrs, one codeword bins
+	};
+#define	QUAL_HIST_BINS		16
+#define	QUAL_HIST_LEN		(4*QUAL_HIST_BINS*2)
+extern	rxQualityType	rxQuality;						// Link quality of the last packet (latched at EOP)
+extern	u32	ulRxQualHist[4][QUAL_HIST_BINS];		// Link quality histograms
+
+//---- link table per destination (link.c) ---------------------------
+typedef struct
+{
+	u16				uAddr;			// destination address, 0xFFFF = unused
+	u16				uSuccess;		// average ack rate, Q8 (256 = 100%)
+	u16				uSnr;			// average SNR of the acks, 1.5 dB steps
+	u16				uFrameLen;		// frame length (bytes) for bulk traffic
+	u16				uRetries;		// retries before a frame is dropped
+	u16				uSent;			// frames sent (including retries)
+	u16				uAcked;			// acks received
+	u16				uRetried;		// retries sent
+	u16				uDropped;		// frames dropped after the last retry
+	u16				uAdaptCnt;		// attempts since the last adaptation
+	u16				uUsed;			// link clock at the last use
+}	linkEntry;
+
+#define	LINK_TABLE_LEN		8
+extern	linkEntry	linkTable[LINK_TABLE_LEN];			// Link state per destination
+extern	linkEntry	*LinkFind(u16 uAddr);
+extern	void		LinkResult(linkEntry *pLink, u16 uOk, u16 uSnr);
+
+//---- reliable delivery, selective repeat ARQ (arq.c) ----------------
+#define	ARQ_WINDOW			4				// frames in flight per sender (and slots)
+#define	ARQ_BUSY			0xFFFF			// ArqQueue(): no free slot
+#define	ARQ_STATS_LEN		(7*2)
+enum {
+	ARQ_SENT_FRAMES,		// 0	data frames sent, including resends
+	ARQ_RESENT,				// 1	resends after an ack timeout
+	ARQ_ACKED,				// 2	frames acked
+	ARQ_DROPPED,			// 3	frames dropped after the last retry
+	ARQ_DELIVERED,			// 4	received commands executed
+	ARQ_DUPLICATES,			// 5	received frames already held or executed
+	ARQ_SKIPPED				// 6	received sequence numbers the sender dropped
+	};
+extern	u32	ulArqStats[ARQ_STATS_LEN/2];			// Statistics for reliable delivery
+
+//---- multi-hop repeater (relay.c) ----------------------------------
+#define	RELAY_BUSY			0xFFFF			// RelaySend(): a frame is still waiting to be sent
+#define	RELAY_STATS_LEN		(7*2)
+enum {
+	RELAY_ORIGINATED,		// 0	frames started here
+	RELAY_FORWARDED,		// 1	frames repeated for other nodes
+	RELAY_DELIVERED,		// 2	received commands run here
+	RELAY_DUPLICATES,		// 3	frames heard again
+	RELAY_SUPPRESSED,		// 4	repeats dropped because another node repeated first
+	RELAY_DROPPED,			// 5	repeats dropped because one was already waiting
+	RELAY_CMD_BUSY			// 6	commands for here not run yet, the command task was busy
+	};
+extern	u32	ulRelayStats[RELAY_STATS_LEN/2];		// Statistics for the repeater
+
+//---- kernel cross-check (kernels.c) -------------------------------
+#define	KERNEL_CHECK_LEN	9				// words returned by KernelCheck() / CMD_KERNEL_CHECK
+
+//---- host call counts for the ramfuncs placement (prof.c) ----------
+enum {
+	PROF_RECEIVE,			// 0	receive(), once per receive sample
+	PROF_RXDEMOD,			// 1
+	PROF_RXQUALITYLATCH,	// 2
+	PROF_LOG2Q1,			// 3
+	PROF_RESET_TO_BITSYNC,	// 4
+	PROF_PROCESSRXPLCMSG,	// 5
+	PROF_CALCCRC,			// 6
+	PROF_FUNCS
+	};
+#ifdef MEX_COMPILE
+	extern	u32	ulProfCalls[PROF_FUNCS];			// Calls counted by PROF()
+	#define	PROF(id)		(ulProfCalls[id]++)
+#else
+	#define	PROF(id)							// nothing on the target
+#endif
+
+//---- cooperative task scheduler (sched.c) --------------------------
+#define	SCHED_MAX_TASKS		10
+#define	SCHED_FULL			0xFFFF			// SchedAdd(): no free entry
+#define	SCHED_SLOT_CYCLES	((u16)(DSP_FREQ / RX_Sampling))	// CPU cycles per receive sample
+#define	SCHED_MARGIN		100				// cycles kept free ahead of the next ADC interrupt
+enum {SCHED_URGENT, SCHED_NORMAL, SCHED_BACKGROUND};	// priorities, highest first
+typedef struct
+{
+	void			(*pfRun)(void);		// task body
+	u16				(*pfReady)(void);	// True when there is work to do, 0 = always ready
+	u16				uPeriod;		// receive samples between runs, 1 = every sample
+	u16				uPriority;		// SCHED_URGENT runs even past the deadline
+	u16				uDue;			// samples until the task is due, 0 = due
+	u16				uWait;			// samples a due task has waited for slack
+	u16				uEstCycles;		// expected run time: decaying peak, CPU cycles
+	u16				uLastCycles;	// run time of the last run, CPU cycles
+	u16				uMaxCycles;		// longest run, CPU cycles
+	u32				ulRuns;			// runs
+	u32				ulDeferred;		// samples a due task waited for slack
+}	schedTask;
+extern	schedTask		schedTable[SCHED_MAX_TASKS];	// Tasks, highest priority first
+extern	u16				uSchedTasks;					// Entries used in schedTable[]
+extern	volatile u32	ulAdcIntStamp;					// CYCLE_COUNT() at the last ADC interrupt
+
+//---- CPU load meter (load.c) ---------------------------------------
+#define	CYCLE_COUNT()		(~CpuTimer1Regs.TIM.all)	// free-running CPU cycle count (CpuTimer1)
+enum {
+	LOAD_ISR,				// 0	adc_isr()
+	LOAD_IDLE,				// 1	IDLE wait, less the interrupts
+	LOAD_LOOP,				// 2	rest of MainLoop(): scheduler, loop, timer interrupt
+	LOAD_TASK				// 3	first task, LOAD_TASK + i = schedTable[i]
+	};
+#define	LOAD_BUCKETS		(LOAD_TASK + SCHED_MAX_TASKS)
+enum {LOAD_LAST, LOAD_MIN, LOAD_AVG, LOAD_MAX};	// uLoadStats[][] words, 0.1 % units
+#define	LOAD_STAT_WORDS		4
+#define	LOAD_STATS_LEN		(2 + LOAD_BUCKETS*LOAD_STAT_WORDS)	// words of the CMD_LOAD_STATS reply
+extern	u32		ulLoadCycles[LOAD_BUCKETS];			// Cycles per bucket in the current second
+extern	u16		uLoadStats[LOAD_BUCKETS][LOAD_STAT_WORDS];	// Last, min, avg, max per bucket
+extern	u16		uLoadIsrMax;						// Longest single adc_isr() run, CPU cycles
+extern	u16		uLoadSeconds;						// Seconds measured since LoadReset()
+
+//---- boot phase times (main.c) ------------------------------------
+enum {
+	BOOT_PIE,				// 0	GPIO, PIE control and vector table
+	BOOT_ADC_START,			// 1	ADC reset, reference powered up
+	BOOT_FLASH,				// 2	BootCopy(), InitFlash()
+	BOOT_TABLES,			// 3	FecInit()
+	BOOT_PERIPH,			// 4	CPU timer 0, SCI
+	BOOT_GLOBALS,			// 5	InitializeGlobals(), UART array
+	BOOT_ADDRESS,			// 6	node address, wait_for_address (ADDRESS_WAIT)
+	BOOT_NET,				// 7	PLL reset, lamp, link, ARQ and relay tables
+	BOOT_ADC_READY,			// 8	rest of the reference wait, ADC power up
+	BOOT_INTS,				// 9	PWM/ADC timers, interrupts, sensors armed
+	BOOT_PHASES
+	};
+#define	BOOT_STAMP(phase)	(ulBootStamp[phase] = CYCLE_COUNT())
+#define	BOOT_TIMES_LEN		(BOOT_PHASES*2)	// words of the CMD_BOOT_TIMES reply
+extern	u32		ulBootStamp[BOOT_PHASES];			// CYCLE_COUNT() at the end of each phase
+
+//---- line spectrum / noise floor scanner (scan.c) -----------------
+#define	SCAN_BINS			16				// Goertzel bins, 61 - 90 kHz
+#define	SCAN_MAX_BLOCKS		16				// most blocks summed by one scan
+extern	const u16 uScanFreq[SCAN_BINS];				// Bin centre frequency, 10 Hz units
+extern	u32	ulScanPower[SCAN_BINS];					// Power per bin, summed over the blocks
+extern	u16	uScanActive;							// Flag: scanner is collecting blocks
+extern	u16	uScanBlocksDone;						// Blocks summed into ulScanPower[]
+
+
+//---- host channel model (channel.c) -------------------------------
+#ifdef MEX_COMPILE
+#define	CHAN_MAX_PATHS		4				// echoes in the frequency selective model
+enum {CHAN_AWGN, CHAN_RESIDENTIAL, CHAN_OFFICE, CHAN_INDUSTRIAL};
+typedef struct
+{
+	u16				uEnable;		// True: processReadSamples() runs samples through the model
+	double			dGain;			// flat gain on the signal
+	u16				uPaths;			// echoes used, 0 = flat
+	u16				uPathDelay[CHAN_MAX_PATHS];	// echo delay, samples (1 - 63)
+	double			dPathGain[CHAN_MAX_PATHS];	// echo gain relative to the direct path
+	double			dNoiseRms;		// background noise, ADC counts rms
+	double			dCycloDepth;	// extra noise power at the mains peak (0 = stationary)
+	u16				uCycloExp;		// shape of the noise over the half cycle, |sin|^n
+	double			dSyncRms;		// mains synchronous impulse, ADC counts rms (0 = none)
+	double			dSyncPhase;		// start of the impulse, 0 - 1 of the half cycle
+	double			dSyncLenMs;		// length of the impulse
+	double			dImpRate;		// asynchronous bursts per second (0 = none)
+	double			dImpLenMs;		// mean burst length
+	double			dImpRms;		// burst level, ADC counts rms
+	double			dRecGain;		// gain on the recorded noise (0 = off)
+}	chanModel;
+extern	chanModel	chanCfg;						// Channel model used by processReadSamples()
+#endif
 
 // Trace buffer global variable declarations and values.
 #if (TRACE_BUF_LEN > 0)
@@ -0,0 +1,178 @@
+//==========================================================================================
+// Filename:		mains.c
+//
+// Description:		Mains zero-crossing detection and transmit scheduling.
+//
+//					The mains sense input is converted once per receive sample as the
+//					last conversion of the ADC sequence (see ArmAllSensors()).  Each half
+//					cycle of the mains is split into ZC_PHASE_BINS phase bins.  Blanked
+//					samples (impulse noise) are counted per bin, and transmit frames are
+//					started in the window of ZC_TX_BINS bins with the least impulse noise.
+//					Receive results are also counted per bin of the preamble, for
+//					CMD_READ_ZC_STATS.
+//
+//					Until a valid mains period has been measured, and without a mains
+//					signal (uZcPeriod == 0), transmit is not delayed.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Transmit window of ZC_TX_BINS bins; no bin steps before the first period.
+//==========================================================================================
+
+#include "main.h"
+
+#define	RAMFUNCS_MAINS						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	ZC_HYST				1024		// hysteresis on the signed mains sense sample
+#define	ZC_PERIOD_MIN		((u16)(RX_Sampling/65))		// shortest valid mains cycle (samples)
+#define	ZC_PERIOD_MAX		((u16)(RX_Sampling/45))		// longest valid mains cycle (samples)
+#define	ZC_EVAL_CYCLES		64			// re-select the quiet bin every N mains cycles
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u16		uZcPeriod = 0;					// samples per mains cycle, 0 = no mains sync
+u16		uZcBin = 0;						// current phase bin within the mains half cycle
+u16		uZcTxBin = 0;					// first phase bin of the transmit window
+u16		uZcRxBin = 0;					// phase bin of the last preamble detection
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+u16		uZcPhase = 0;					// samples since the last rising zero crossing
+u16		uZcState = 0;					// sign of the mains sense, with hysteresis
+u16		uZcBinLen = 0;					// samples per phase bin, 0 until the first valid period
+u16		uZcBinCnt = 0;					// samples into the current phase bin
+u16		uZcCycles = 0;					// mains cycles since the quiet bin was chosen
+
+
+//==========================================================================================
+// Function:		ZcDetect()
+//
+// Description: 	Called by adc_isr() once per receive sample with the signed mains sense
+//					sample.  Tracks the rising zero crossing, the mains period and the
+//					phase bin.  Every ZC_EVAL_CYCLES cycles the ZC_TX_BINS bins with the
+//					fewest blanked samples become the transmit window and the noise
+//					counts are halved, so the choice follows changes in the load.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Bins only step once the bin length is known; window of ZC_TX_BINS.
+//==========================================================================================
+void ZcDetect(s16 sMains)
+{
+	u16		i, j;
+	u32		ulSum;						// blanked samples in a candidate window
+	u32		ulBest;						// fewest blanked samples in any window
+
+	uZcPhase++;
+
+	//---- phase bin within the half cycle ---------------
+	if ((uZcBinLen != 0) && (++uZcBinCnt >= uZcBinLen))
+	{
+		uZcBinCnt = 0;
+		if (++uZcBin >= ZC_PHASE_BINS)
+			uZcBin = 0;						// second half cycle starts over
+	}
+
+	//---- rising zero crossing --------------------------
+	if (uZcState)
+	{
+		if (sMains < -ZC_HYST)
+			uZcState = 0;
+	}
+	else if (sMains > ZC_HYST)
+	{
+		uZcState = 1;
+
+		if ((uZcPhase >= ZC_PERIOD_MIN) && (uZcPhase <= ZC_PERIOD_MAX))
+		{
+			uZcPeriod = uZcPhase;
+			uZcBinLen = (uZcPeriod >> 1) / ZC_PHASE_BINS;
+		}
+		else
+		{
+			uZcPeriod = 0;					// not a mains signal
+		}
+		uZcPhase = 0;
+		uZcBin = 0;
+		uZcBinCnt = 0;
+
+		//---- choose the quietest window for transmit -------
+		if (++uZcCycles >= ZC_EVAL_CYCLES)
+		{
+			uZcCycles = 0;
+			ulBest = 0xFFFFFFFF;
+			for (i=0; i<ZC_PHASE_BINS; i++)
+			{
+				ulSum = 0;
+				for (j=0; j<ZC_TX_BINS; j++)
+					ulSum += ulZcNoise[(i + j) % ZC_PHASE_BINS];
+				if (ulSum < ulBest)
+				{
+					ulBest = ulSum;
+					uZcTxBin = i;
+				}
+			}
+			for (i=0; i<ZC_PHASE_BINS; i++)
+			{
+				ulZcNoise[i] >>= 1;
+			}
+		}
+	}
+
+	//---- mains lost --------------------------------------
+	if (uZcPhase > ZC_PERIOD_MAX)
+	{
+		uZcPeriod = 0;
+		uZcPhase = ZC_PERIOD_MAX;
+	}
+}
+
+
+//==========================================================================================
+// Function:		ZcTxWindowOpen()
+//
+// Description: 	Returns True if a transmit frame may start now: either there is no
+//					valid mains period yet, or the mains is in one of the ZC_TX_BINS
+//					quiet phase bins from uZcTxBin on.  The window comes around every
+//					half cycle, so the wait is short.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Open without a measured bin length; window of ZC_TX_BINS bins.
+//==========================================================================================
+u16 ZcTxWindowOpen(void)
+{
+	if ((uZcPeriod == 0) || (uZcBinLen == 0))
+		return (True);
+
+	return ((((uZcBin + ZC_PHASE_BINS - uZcTxBin) % ZC_PHASE_BINS) < ZC_TX_BINS) ? True : False);
+}
+
+
+//==========================================================================================
+// Function:		ZcCountRx()
+//
+// Description: 	Count a receive result against the mains phase bin in which its
+//					preamble was detected.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ZcCountRx(u16 uResult)
+{
+	if (uZcPeriod != 0)
+		ulZcStats[uZcRxBin][uResult]++;
+}
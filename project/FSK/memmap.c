@@ -0,0 +1,407 @@
+//==========================================================================================
+// Filename:		memmap.c
+//
+// Description:		Memory footprint report from a linker map (host build).
+//
+//					MapReport() reads the map of a target build and writes, for RAM and
+//					for flash: each memory range with its use, each output section and
+//					each global symbol with its size, largest first.  It only reads the
+//					map, so it works for the map of either project:
+//
+//					MapReport(".\\Release\\PLC.map", "memfsk.txt");		// FSK, F2808
+//					MapReport("..\\PSK\\PSK2812.map", "mempsk.txt");	// PSK, F2812
+//
+//					A symbol's size is the distance to the next symbol, cut at the end of
+//					its output section, so the last variable of a section is not charged
+//					with the gap behind it.  Symbols of a section that is loaded to flash
+//					and run from RAM ("ramfuncs") are at their run address and count in
+//					both.  Addresses are classed by the F280x/F281x memory map: M0/M1,
+//					L0/L1 and H0 SARAM are RAM, 0x3D7800 up to H0 is flash/OTP; the
+//					peripheral frames and boot ROM are left out.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdio.h>						// fopen(), fgets(), fprintf()
+#include <stdlib.h>						// qsort()
+#include <string.h>						// strcmp(), strstr(), strchr(), strncpy()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	MAP_SYMBOLS			4096		// symbols read from the map
+#define	MAP_SECTIONS		128			// output sections read from the map
+#define	MAP_RANGES			32			// MEMORY ranges read from the map
+#define	MAP_NAME_LEN		48			// longest name kept
+
+enum {									// address classes
+	MAP_OTHER = 0,						// peripheral frames, boot ROM, XINTF
+	MAP_RAM,
+	MAP_FLASH,
+	MAP_BOTH,							// loaded to flash, run from RAM
+	MAP_CLASSES
+};
+
+enum {									// part of the map being read
+	MAP_PART_NONE = 0,
+	MAP_PART_MEMORY,					// MEMORY CONFIGURATION
+	MAP_PART_SECTIONS,					// SECTION ALLOCATION MAP
+	MAP_PART_SYMBOLS					// GLOBAL SYMBOLS
+};
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	char	cName[MAP_NAME_LEN];
+	u32		ulOrigin;					// run address
+	u32		ulLength;					// words
+	u32		ulUsed;						// words (memory ranges only)
+	u32		ulLoad;						// load address if not the run address, else ~0
+	u16		uClass;						// MAP_RAM, MAP_FLASH, ...
+}	mapArea;
+
+typedef struct
+{
+	char	cName[MAP_NAME_LEN];
+	u32		ulAddr;
+	u32		ulSize;						// words
+	u16		uClass;
+}	mapSymbol;
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static mapArea		mapRange[MAP_RANGES];
+static mapArea		mapSection[MAP_SECTIONS];
+static mapSymbol	mapSym[MAP_SYMBOLS];
+static u16			uMapRanges;
+static u16			uMapSections;
+static u16			uMapSyms;
+
+static const char	*cMapClass[MAP_CLASSES] = {"other", "RAM", "flash", "flash+RAM"};
+
+
+//==========================================================================================
+// Function:		MapClass()
+//
+// Description: 	Address class of a target address.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u16 MapClass(u32 ulAddr)
+{
+	if (ulAddr < 0x000800)
+		return (MAP_RAM);						// M0, M1
+	if ((ulAddr >= 0x008000) && (ulAddr < 0x00A000))
+		return (MAP_RAM);						// L0, L1
+	if ((ulAddr >= 0x3F8000) && (ulAddr < 0x3FA000))
+		return (MAP_RAM);						// H0
+	if ((ulAddr >= 0x3D7800) && (ulAddr < 0x3F8000))
+		return (MAP_FLASH);						// OTP and flash
+	return (MAP_OTHER);
+}
+
+
+//==========================================================================================
+// Function:		MapBySize(), MapByAddr()
+//
+// Description: 	qsort() compare functions for mapSymbol.
+//
+// Revision History:
+// 19Oct26			New functions.
+//==========================================================================================
+static int MapBySize(const void *p1, const void *p2)
+{
+	const mapSymbol	*pS1 = (const mapSymbol *)p1;
+	const mapSymbol	*pS2 = (const mapSymbol *)p2;
+
+	if (pS1->ulSize != pS2->ulSize)
+		return ((pS1->ulSize > pS2->ulSize) ? -1 : 1);
+	return (strcmp(pS1->cName, pS2->cName));
+}
+
+static int MapByAddr(const void *p1, const void *p2)
+{
+	const mapSymbol	*pS1 = (const mapSymbol *)p1;
+	const mapSymbol	*pS2 = (const mapSymbol *)p2;
+
+	if (pS1->ulAddr != pS2->ulAddr)
+		return ((pS1->ulAddr < pS2->ulAddr) ? -1 : 1);
+	return (strcmp(pS1->cName, pS2->cName));
+}
+
+
+//==========================================================================================
+// Function:		MapRead()
+//
+// Description: 	Read the memory ranges, output sections and global symbols of a
+//					linker map.  Both symbol listings (by name and by address) are read
+//					and the duplicates dropped.  Returns False if the map cannot be read.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u16 MapRead(const char *pMapFile)
+{
+	FILE	*pF;
+	char	cLine[256];
+	char	cName[128];
+	char	cPending[MAP_NAME_LEN];			// section name alone on its line
+	char	*pRun;						// "RUN ADDR =", or where a range starts
+	u32		ulPage, ulA, ulB, ulC;
+	u16		uPart = MAP_PART_NONE;
+	u16		i, n;
+	mapArea	*pA;
+
+	pF = fopen(pMapFile, "r");
+	if (pF == 0)
+		return (False);
+
+	uMapRanges = 0;
+	uMapSections = 0;
+	uMapSyms = 0;
+	cPending[0] = 0;
+
+	while (fgets(cLine, sizeof(cLine), pF) != 0)
+	{
+		if (strstr(cLine, "MEMORY CONFIGURATION") != 0)
+		{
+			uPart = MAP_PART_MEMORY;
+			continue;
+		}
+		if (strstr(cLine, "SECTION ALLOCATION MAP") != 0)
+		{
+			uPart = MAP_PART_SECTIONS;
+			continue;
+		}
+		if (strstr(cLine, "GLOBAL SYMBOLS") != 0)
+		{
+			uPart = MAP_PART_SYMBOLS;
+			continue;
+		}
+
+		switch (uPart)
+		{
+		case MAP_PART_MEMORY:				// "  RAMM1   00000400   00000400  00000123 ..."
+			pRun = cLine;
+			if ((strncmp(cLine, "PAGE", 4) == 0) && (strchr(cLine, ':') != 0))
+				pRun = strchr(cLine, ':') + 1;	// first range of a page: "PAGE  1: RAMM1 ..."
+			if ((sscanf(pRun, "%127s %lx %lx %lx", cName, &ulA, &ulB, &ulC) != 4)
+				|| (uMapRanges >= MAP_RANGES))
+				break;
+			pA = &mapRange[uMapRanges++];
+			strncpy(pA->cName, cName, MAP_NAME_LEN-1);
+			pA->cName[MAP_NAME_LEN-1] = 0;
+			pA->ulOrigin = ulA;
+			pA->ulLength = ulB;
+			pA->ulUsed = ulC;
+			pA->ulLoad = 0xFFFFFFFF;
+			pA->uClass = MapClass(ulA);
+			break;
+
+		case MAP_PART_SECTIONS:				// ".text   0   003f6000   00001523"
+			if ((cLine[0] == ' ') || (cLine[0] == '\t') || (cLine[0] == '-'))
+				break;						// input sections, blank lines, rulers
+			if ((sscanf(cLine, "%127s %lu %lx %lx", cName, &ulPage, &ulA, &ulB) != 4)
+				|| (uMapSections >= MAP_SECTIONS))
+			{
+				if (sscanf(cLine, "%127s", cName) == 1)
+				{
+					strncpy(cPending, cName, MAP_NAME_LEN-1);	// long name, numbers follow
+					cPending[MAP_NAME_LEN-1] = 0;
+				}
+				break;
+			}
+			pA = &mapSection[uMapSections++];
+			strncpy(pA->cName, (strcmp(cName, "*") == 0) ? cPending : cName, MAP_NAME_LEN-1);
+			pA->cName[MAP_NAME_LEN-1] = 0;
+			pA->ulOrigin = ulA;
+			pA->ulLength = ulB;
+			pA->ulUsed = ulB;
+			pA->ulLoad = 0xFFFFFFFF;
+			pRun = strstr(cLine, "RUN ADDR =");
+			if ((pRun != 0) && (sscanf(pRun + 10, "%lx", &ulC) == 1))
+			{
+				pA->ulLoad = ulA;			// the listed origin is the load address
+				pA->ulOrigin = ulC;
+			}
+			pA->uClass = MapClass(pA->ulOrigin);
+			if ((pA->ulLoad != 0xFFFFFFFF) && (MapClass(pA->ulLoad) == MAP_FLASH))
+				pA->uClass = MAP_BOTH;
+			cPending[0] = 0;
+			break;
+
+		case MAP_PART_SYMBOLS:				// "003f4000 _name" or "0  003f4000  _name"
+			if ((sscanf(cLine, "%lx %127s", &ulA, cName) != 2) || (cName[0] != '_'))
+			{
+				if ((sscanf(cLine, "%lu %lx %127s", &ulPage, &ulA, cName) != 3) || (cName[0] != '_'))
+					break;
+			}
+			if ((strncmp(cName, "___", 3) == 0) && (strstr(cName + 3, "__") != 0))
+				break;						// linker section boundaries (___bss__ ...)
+			if (uMapSyms >= MAP_SYMBOLS)
+				break;
+			strncpy(mapSym[uMapSyms].cName, &cName[1], MAP_NAME_LEN-1);
+			mapSym[uMapSyms].cName[MAP_NAME_LEN-1] = 0;
+			mapSym[uMapSyms].ulAddr = ulA;
+			mapSym[uMapSyms].ulSize = 0;
+			mapSym[uMapSyms].uClass = MapClass(ulA);
+			uMapSyms++;
+			break;
+		}
+	}
+	fclose(pF);
+
+	//---- drop the second listing, size each symbol -----------------
+	qsort(mapSym, uMapSyms, sizeof(mapSymbol), MapByAddr);
+	for (i=0, n=0; i<uMapSyms; i++)
+	{
+		if ((n > 0) && (mapSym[i].ulAddr == mapSym[n-1].ulAddr)
+			&& (strcmp(mapSym[i].cName, mapSym[n-1].cName) == 0))
+			continue;
+		mapSym[n++] = mapSym[i];
+	}
+	uMapSyms = n;
+
+	for (i=0; i<uMapSyms; i++)
+	{
+		pA = 0;
+		for (n=0; n<uMapSections; n++)
+		{
+			if ((mapSym[i].ulAddr >= mapSection[n].ulOrigin)
+				&& (mapSym[i].ulAddr < mapSection[n].ulOrigin + mapSection[n].ulLength))
+				pA = &mapSection[n];
+		}
+		if (pA == 0)
+			continue;						// absolute symbol or register frame
+		if (pA->uClass == MAP_BOTH)
+			mapSym[i].uClass = MAP_BOTH;
+
+		ulA = pA->ulOrigin + pA->ulLength;	// end of the section
+		for (n=i+1; n<uMapSyms; n++)
+		{
+			if (mapSym[n].ulAddr > mapSym[i].ulAddr)
+			{
+				ulA = Min(ulA, mapSym[n].ulAddr);
+				break;
+			}
+		}
+		mapSym[i].ulSize = ulA - mapSym[i].ulAddr;
+	}
+
+	return (True);
+}
+
+
+//==========================================================================================
+// Function:		MapReport()
+//
+// Description: 	Write the memory footprint of the build whose linker map is pMapFile
+//					to pOutFile and print the totals.  Returns the RAM words used by the
+//					output sections, 0 if the map cannot be read.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u32 MapReport(const char *pMapFile, const char *pOutFile)
+{
+	FILE	*pF;
+	u32		ulTotal[MAP_CLASSES];
+	u32		ulSize[MAP_CLASSES];
+	u32		ulFree;
+	u16		uClass;
+	u16		i;
+
+	if (MapRead(pMapFile) != True)
+	{
+		mexPrintf("memmap: cannot read %s\n", pMapFile);
+		return (0);
+	}
+	pF = fopen(pOutFile, "w");
+	if (pF == 0)
+	{
+		mexPrintf("memmap: cannot write %s\n", pOutFile);
+		return (0);
+	}
+
+	fprintf(pF, "Memory footprint of %s (16-bit words)\n", pMapFile);
+
+	//---- memory ranges -------------------------------------------
+	memset(ulTotal, 0, sizeof(ulTotal));
+	memset(ulSize, 0, sizeof(ulSize));
+	fprintf(pF, "\n%-24s %-9s %8s %8s %8s %8s\n", "range", "class", "origin", "length", "used", "free");
+	for (i=0; i<uMapRanges; i++)
+	{
+		fprintf(pF, "%-24s %-9s %08lx %8lu %8lu %8lu\n", mapRange[i].cName, cMapClass[mapRange[i].uClass],
+			mapRange[i].ulOrigin, mapRange[i].ulLength, mapRange[i].ulUsed,
+			mapRange[i].ulLength - Min(mapRange[i].ulUsed, mapRange[i].ulLength));
+		ulTotal[mapRange[i].uClass] += mapRange[i].ulUsed;
+		ulSize[mapRange[i].uClass] += mapRange[i].ulLength;
+	}
+	for (uClass=MAP_RAM; uClass<=MAP_FLASH; uClass++)
+	{
+		ulFree = ulSize[uClass] - Min(ulTotal[uClass], ulSize[uClass]);
+		fprintf(pF, "%-24s %-9s %8s %8lu %8lu %8lu\n", "total", cMapClass[uClass], "",
+			ulSize[uClass], ulTotal[uClass], ulFree);
+		mexPrintf("memmap: %-5s %6lu of %6lu words used in the MEMORY ranges\n",
+			cMapClass[uClass], ulTotal[uClass], ulSize[uClass]);
+	}
+
+	//---- output sections -----------------------------------------
+	memset(ulTotal, 0, sizeof(ulTotal));
+	fprintf(pF, "\n%-24s %-9s %8s %8s %8s\n", "section", "class", "run", "load", "words");
+	for (i=0; i<uMapSections; i++)
+	{
+		fprintf(pF, "%-24s %-9s %08lx ", mapSection[i].cName, cMapClass[mapSection[i].uClass],
+			mapSection[i].ulOrigin);
+		if (mapSection[i].ulLoad != 0xFFFFFFFF)
+			fprintf(pF, "%08lx ", mapSection[i].ulLoad);
+		else
+			fprintf(pF, "%8s ", "");
+		fprintf(pF, "%8lu\n", mapSection[i].ulLength);
+		ulTotal[mapSection[i].uClass] += mapSection[i].ulLength;
+	}
+	ulTotal[MAP_RAM] += ulTotal[MAP_BOTH];
+	ulTotal[MAP_FLASH] += ulTotal[MAP_BOTH];
+	for (uClass=MAP_RAM; uClass<=MAP_FLASH; uClass++)
+	{
+		fprintf(pF, "%-24s %-9s %26lu\n", "total", cMapClass[uClass], ulTotal[uClass]);
+		mexPrintf("memmap: %-5s %6lu words in output sections\n", cMapClass[uClass], ulTotal[uClass]);
+	}
+
+	//---- symbols, largest first ------------------------------------
+	qsort(mapSym, uMapSyms, sizeof(mapSymbol), MapBySize);
+	for (uClass=MAP_RAM; uClass<MAP_CLASSES; uClass++)
+	{
+		if (uClass == MAP_OTHER)
+			continue;
+		fprintf(pF, "\n%-40s %-9s %8s %8s\n", "symbol", "class", "address", "words");
+		for (i=0; i<uMapSyms; i++)
+		{
+			if ((mapSym[i].uClass != uClass) || (mapSym[i].ulSize == 0))
+				continue;
+			fprintf(pF, "%-40s %-9s %08lx %8lu\n", mapSym[i].cName, cMapClass[uClass],
+				mapSym[i].ulAddr, mapSym[i].ulSize);
+		}
+	}
+	fclose(pF);
+
+	return (ulTotal[MAP_RAM]);
+}
+
+#endif	// MEX_COMPILE
@@ -0,0 +1,406 @@
+//==========================================================================================
+// Filename:		plcsim.c
+//
+// Description:		Host simulation of many modems on one shared power line.
+//
+//					Each node keeps its own copy of the MainLoop and receive() state
+//					that decides who gets on the air: uRxMode (FIND_BITSYNC, locked on a
+//					frame, EOP_HOLD_OFF with the random hold off of receive()), plcMode,
+//					uTxMsgPending and the flood timer of MainLoop task 6.  All nodes are
+//					stepped together, one ADC sample at a time, and a node starts a
+//					frame under the same rule as MainLoop: a message is pending, the
+//					receiver is in FIND_BITSYNC and the mains zero-crossing window is
+//					open (ZC_SYNC).
+//
+//					The line is a matrix of per-pair attenuation (dB) and delay (samples)
+//					from random positions along a cable.  Signals are carried as levels,
+//					not waveforms: a receiver detects a preamble BITSYNC_BITS after it
+//					arrives if its SNR is at least PLCSIM_SNR_DETECT and it is not
+//					drowned by the frames already on the line, and the frame is good if
+//					the signal to noise plus interference ratio stays at or above
+//					PLCSIM_SIR_DECODE for the whole frame.  Frame lengths come from
+//					PLC_FRAME_BITS() and TX_BIT_COUNT.
+//
+//					For each destination the outcome of a frame is one of: delivered,
+//					collided (too much interference), busy (destination was sending or
+//					locked on another frame when the preamble came) or out of reach.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdlib.h>						// rand()
+#include <string.h>						// contains memset()
+#include <math.h>						// pow(), log10(), fabs()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	PLCSIM_MAX_NODES	200
+#define	PLCSIM_FRAMES		1024		// frame history, must outlast the longest overlap
+#define	PLCSIM_ARRIVALS		32			// preambles in flight per receiver
+#define	PLCSIM_MSG_LEN		MAX_TX_MSG_LEN	// flood frames are full length
+
+#define	PLCSIM_LINE_M		300.0		// length of the cable the nodes are spread on
+#define	PLCSIM_ATT_BASE		6.0			// coupling loss, dB
+#define	PLCSIM_ATT_PER_M	0.15		// cable loss, dB per metre
+#define	PLCSIM_ATT_SPREAD	12.0		// random extra loss per pair (branches, loads), dB
+#define	PLCSIM_TX_SNR		70.0		// SNR at the transmitter, dB over the noise floor
+#define	PLCSIM_M_PER_SEC	1.5e8		// propagation speed on the cable
+#define	PLCSIM_SNR_DETECT	6.0			// preamble detection, dB
+#define	PLCSIM_SIR_DECODE	8.0			// error free frame, dB
+
+#define	PLCSIM_MAINS_HZ		60
+#define	BITSYNC_BITS		16			// preamble bits before BITSYNC_PATTERN matches
+#define	EOP_HOLD_MIN		(11*21*2)	// receive(): uEOP_holdOffCnt = 11*21*2 + (counter & 0x7FF)
+#define	EOP_HOLD_MASK		0x7FF
+
+enum {SIM_DELIVERED, SIM_COLLIDED, SIM_BUSY, SIM_UNREACHED, SIM_OUTCOMES};
+
+#define	SIM_LOCKED			0xFFFF		// uRxMode while a frame is being received
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	u16		uFrom;
+	u16		uDest;
+	u32		ulStart;					// first sample on the line at the sender
+	u32		ulLen;						// samples
+} simFrame;
+
+typedef struct
+{
+	u32		ulAt;						// sample the preamble is detected
+	u32		ulFrame;					// frame number
+} simArrival;
+
+typedef struct
+{
+	u16		uRxMode;					// FIND_BITSYNC, EOP_HOLD_OFF or SIM_LOCKED
+	u16		plcMode;					// RX_MODE, TX_MODE
+	u16		uTxMsgPending;
+	u32		ulTxEnd;					// last sample of the frame being sent
+	u32		ulRxFrame;					// frame locked on
+	u32		ulRxEnd;					// last sample of the frame locked on
+	u32		ulHoldOff;					// samples left in EOP_HOLD_OFF
+	u32		ulFloodStamp;				// sample of the last flood message
+	u16		uArrivals;
+	simArrival	arrival[PLCSIM_ARRIVALS];
+} simNode;
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static simNode	simNodes[PLCSIM_MAX_NODES];
+static simFrame	simFrames[PLCSIM_FRAMES];
+static float	fSimSnr[PLCSIM_MAX_NODES][PLCSIM_MAX_NODES];	// dB, from-to
+static u16		uSimDelay[PLCSIM_MAX_NODES][PLCSIM_MAX_NODES];	// samples, from-to
+static u32		ulSimFrames;				// frames sent so far
+static u32		ulSimOutcome[SIM_OUTCOMES];
+
+
+//==========================================================================================
+// Function:		PlcSimLine()
+//
+// Description: 	Place uNodes nodes at random along the cable and fill the per-pair
+//					SNR and delay.  The line is reciprocal.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void PlcSimLine(u16 uNodes)
+{
+	double	dPos[PLCSIM_MAX_NODES];
+	double	dDist;
+	u16		i, j;
+
+	for (i=0; i<uNodes; i++)
+		dPos[i] = PLCSIM_LINE_M * rand() / RAND_MAX;
+
+	for (i=0; i<uNodes; i++)
+	{
+		fSimSnr[i][i] = (float)PLCSIM_TX_SNR;
+		uSimDelay[i][i] = 0;
+		for (j=i+1; j<uNodes; j++)
+		{
+			dDist = fabs(dPos[i] - dPos[j]);
+			fSimSnr[i][j] = (float)(PLCSIM_TX_SNR - PLCSIM_ATT_BASE - PLCSIM_ATT_PER_M*dDist
+							 - PLCSIM_ATT_SPREAD * rand() / RAND_MAX);
+			fSimSnr[j][i] = fSimSnr[i][j];
+			uSimDelay[i][j] = (u16)(dDist / PLCSIM_M_PER_SEC * RX_Sampling + 0.5);
+			uSimDelay[j][i] = uSimDelay[i][j];
+		}
+	}
+}
+
+
+//==========================================================================================
+// Function:		PlcSimSir()
+//
+// Description: 	Signal to noise plus interference ratio (dB) of frame ulFrame at
+//					node uRx, taking every other frame that is on the line at uRx in
+//					samples ulFirst..ulLast.  Returns -1000 if uRx itself sent in that
+//					time, since the receiver is blind while transmitting.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double PlcSimSir(u32 ulFrame, u16 uRx, u32 ulFirst, u32 ulLast)
+{
+	simFrame	*pF = &simFrames[ulFrame % PLCSIM_FRAMES];
+	simFrame	*pG;
+	double		dNoise = 1.0;				// noise floor is 0 dB
+	u32			ulG, ulFrom, ulTo;
+
+	ulG = (ulSimFrames > PLCSIM_FRAMES) ? (ulSimFrames - PLCSIM_FRAMES) : 0;
+	for (; ulG<ulSimFrames; ulG++)
+	{
+		if (ulG == ulFrame)
+			continue;
+		pG = &simFrames[ulG % PLCSIM_FRAMES];
+		ulFrom = pG->ulStart + uSimDelay[pG->uFrom][uRx];
+		ulTo = ulFrom + pG->ulLen - 1;
+		if ((ulTo < ulFirst) || (ulFrom > ulLast))
+			continue;
+		if (pG->uFrom == uRx)
+			return (-1000.0);
+		dNoise += pow(10.0, fSimSnr[pG->uFrom][uRx] / 10.0);
+	}
+	return (fSimSnr[pF->uFrom][uRx] - 10.0*log10(dNoise));
+}
+
+
+//==========================================================================================
+// Function:		PlcSimSend()
+//
+// Description: 	Node uNode puts a frame on the line at sample ulNow.  Every node that
+//					can hear it gets a preamble arrival BITSYNC_BITS later.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void PlcSimSend(u16 uNode, u16 uNodes, u32 ulNow)
+{
+	simNode		*pN = &simNodes[uNode];
+	simNode		*pR;
+	simFrame	*pF = &simFrames[ulSimFrames % PLCSIM_FRAMES];
+	u16			r;
+
+	pF->uFrom = uNode;
+	pF->uDest = (uNode + 1 + rand() % (uNodes - 1)) % uNodes;
+	pF->ulStart = ulNow;
+	pF->ulLen = (u32)PLC_FRAME_BITS(PLCSIM_MSG_LEN) * TX_BIT_COUNT;
+
+	pN->plcMode = TX_MODE;
+	pN->uTxMsgPending = ~True;
+	pN->ulTxEnd = ulNow + pF->ulLen - 1;
+
+	if (fSimSnr[uNode][pF->uDest] < PLCSIM_SNR_DETECT)
+		ulSimOutcome[SIM_UNREACHED]++;
+
+	for (r=0; r<uNodes; r++)
+	{
+		if ((r == uNode) || (fSimSnr[uNode][r] < PLCSIM_SNR_DETECT))
+			continue;
+		pR = &simNodes[r];
+		if (pR->uArrivals == PLCSIM_ARRIVALS)
+		{
+			if (r == pF->uDest)
+				ulSimOutcome[SIM_BUSY]++;
+			continue;
+		}
+		pR->arrival[pR->uArrivals].ulAt = ulNow + uSimDelay[uNode][r] + (u32)BITSYNC_BITS*TX_BIT_COUNT;
+		pR->arrival[pR->uArrivals].ulFrame = ulSimFrames;
+		pR->uArrivals++;
+	}
+	ulSimFrames++;
+}
+
+
+//==========================================================================================
+// Function:		PlcSimStep()
+//
+// Description: 	One ADC sample of node uNode: preamble detection, end of frame,
+//					EOP_HOLD_OFF countdown, end of transmit, the flood task and the
+//					MainLoop transmit rule.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static void PlcSimStep(u16 uNode, u16 uNodes, u32 ulNow, u32 ulInterval)
+{
+	simNode		*pN = &simNodes[uNode];
+	simFrame	*pF;
+	u16			i;
+	u16			uZcOpen;
+
+	//---- preambles detected this sample --------------------
+	for (i=0; i<pN->uArrivals; )
+	{
+		if (pN->arrival[i].ulAt != ulNow)
+		{
+			i++;
+			continue;
+		}
+		pF = &simFrames[pN->arrival[i].ulFrame % PLCSIM_FRAMES];
+		if ((pN->plcMode == TX_MODE) || (pN->uRxMode == SIM_LOCKED))
+		{
+			if (pF->uDest == uNode)
+				ulSimOutcome[SIM_BUSY]++;
+		}
+		else if (PlcSimSir(pN->arrival[i].ulFrame, uNode, ulNow, ulNow) < PLCSIM_SNR_DETECT)
+		{
+			if (pF->uDest == uNode)
+				ulSimOutcome[SIM_COLLIDED]++;
+		}
+		else
+		{
+			pN->uRxMode = SIM_LOCKED;
+			pN->ulRxFrame = pN->arrival[i].ulFrame;
+			pN->ulRxEnd = pF->ulStart + uSimDelay[pF->uFrom][uNode] + pF->ulLen - 1;
+		}
+		pN->arrival[i] = pN->arrival[--pN->uArrivals];
+	}
+
+	//---- end of the frame being received -------------------
+	if ((pN->uRxMode == SIM_LOCKED) && (ulNow == pN->ulRxEnd))
+	{
+		pF = &simFrames[pN->ulRxFrame % PLCSIM_FRAMES];
+		if (pF->uDest == uNode)
+		{
+			if (PlcSimSir(pN->ulRxFrame, uNode, pF->ulStart + uSimDelay[pF->uFrom][uNode], ulNow) >= PLCSIM_SIR_DECODE)
+				ulSimOutcome[SIM_DELIVERED]++;
+			else
+				ulSimOutcome[SIM_COLLIDED]++;
+		}
+		pN->uRxMode = EOP_HOLD_OFF;
+		pN->ulHoldOff = EOP_HOLD_MIN + (rand() & EOP_HOLD_MASK);
+	}
+	else if (pN->uRxMode == EOP_HOLD_OFF)
+	{
+		if (--pN->ulHoldOff == 0)
+			pN->uRxMode = FIND_BITSYNC;
+	}
+
+	//---- end of transmit -----------------------------------
+	if ((pN->plcMode == TX_MODE) && (ulNow == pN->ulTxEnd))
+		pN->plcMode = RX_MODE;
+
+	//---- task 6: flood message -----------------------------
+	if ((pN->plcMode != TX_MODE) && (pN->uTxMsgPending != True) &&
+		(ulNow - pN->ulFloodStamp >= ulInterval))
+	{
+		pN->uTxMsgPending = True;
+		pN->ulFloodStamp = ulNow;
+	}
+
+	//---- send the pending frame if no frame is coming in ---
+	#if ZC_SYNC == True
+		uZcOpen = ((ulNow % (u32)(RX_Sampling/(2*PLCSIM_MAINS_HZ))) <
+				   (u32)(RX_Sampling/(2*PLCSIM_MAINS_HZ)/ZC_PHASE_BINS*ZC_TX_BINS)) ? True : False;
+	#else
+		uZcOpen = True;
+	#endif
+	if ((pN->uRxMode == FIND_BITSYNC) && (pN->uTxMsgPending == True) &&
+		(pN->plcMode != TX_MODE) && (uZcOpen == True))
+	{
+		PlcSimSend(uNode, uNodes, ulNow);
+	}
+}
+
+
+//==========================================================================================
+// Function:		PlcSim()
+//
+// Description: 	Run uNodes nodes for uSeconds, each flooding a full length frame to
+//					a random other node every uFloodInterval CpuTimer0 ticks (as
+//					CMD_FLOOD), and print one line: frames sent per second, frames
+//					delivered per second, delivered payload bits per second, share of
+//					line time carrying delivered frames, and the share of frames lost
+//					to collisions, to a busy destination and to range.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void PlcSim(u16 uNodes, u16 uFloodInterval, u16 uSeconds)
+{
+	u32		ulNow, ulEnd;
+	u32		ulInterval;
+	u32		ulSent;
+	double	dSec;
+	u16		n;
+
+	if ((uNodes < 2) || (uNodes > PLCSIM_MAX_NODES))
+		return;
+
+	PlcSimLine(uNodes);
+	memset(simNodes, 0, sizeof(simNodes));
+	memset(ulSimOutcome, 0, sizeof(ulSimOutcome));
+	ulSimFrames = 0;
+
+	ulInterval = (u32)((double)uFloodInterval * RX_Sampling / TINTS_PER_SEC);
+	for (n=0; n<uNodes; n++)
+	{
+		simNodes[n].uRxMode = FIND_BITSYNC;
+		simNodes[n].plcMode = RX_MODE;
+		simNodes[n].uTxMsgPending = ~True;
+		simNodes[n].ulFloodStamp = (u32)rand() % (ulInterval + 1);	// nodes power up at random
+		simNodes[n].ulFloodStamp = 0 - simNodes[n].ulFloodStamp;
+	}
+
+	ulEnd = (u32)(uSeconds * RX_Sampling);
+	for (ulNow=1; ulNow<ulEnd; ulNow++)
+	{
+		for (n=0; n<uNodes; n++)
+			PlcSimStep(n, uNodes, ulNow, ulInterval);
+	}
+
+	dSec = uSeconds;
+	ulSent = ulSimOutcome[SIM_DELIVERED] + ulSimOutcome[SIM_COLLIDED] +
+			 ulSimOutcome[SIM_BUSY] + ulSimOutcome[SIM_UNREACHED];
+	if (ulSent == 0)
+		ulSent = 1;
+	mexPrintf("%5d %6d %8.1f %8.1f %8.0f %6.1f %7.1f %6.1f %6.1f\n",
+		uNodes, uFloodInterval,
+		ulSimFrames / dSec,
+		ulSimOutcome[SIM_DELIVERED] / dSec,
+		ulSimOutcome[SIM_DELIVERED] * PLCSIM_MSG_LEN * 8 / dSec,
+		100.0 * ulSimOutcome[SIM_DELIVERED] * PLC_FRAME_BITS(PLCSIM_MSG_LEN) * TX_BIT_COUNT / (dSec * RX_Sampling),
+		100.0 * ulSimOutcome[SIM_COLLIDED] / ulSent,
+		100.0 * ulSimOutcome[SIM_BUSY] / ulSent,
+		100.0 * ulSimOutcome[SIM_UNREACHED] / ulSent);
+}
+
+
+//==========================================================================================
+// Function:		PlcSimSweep()
+//
+// Description: 	PlcSim() for 2 to 200 nodes at one flood interval per node.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void PlcSimSweep(u16 uFloodInterval, u16 uSeconds)
+{
+	static const u16 uNodeCounts[] = {2, 5, 10, 20, 50, 100, 200};
+	u16		i;
+
+	mexPrintf("nodes  ticks   sent/s  deliv/s   bits/s  util%% collid%%  busy%% range%%\n");
+	for (i=0; i<sizeof(uNodeCounts)/sizeof(uNodeCounts[0]); i++)
+		PlcSim(uNodeCounts[i], uFloodInterval, uSeconds);
+}
+
+#endif	// MEX_COMPILE
@@ -0,0 +1,345 @@
+//==========================================================================================
+// Filename:		prof.c
+//
+// Description:		Profile-guided placement of code in the "ramfuncs" section (host build).
+//
+//					Flash runs with wait states, the H0 RAM that "ramfuncs" is copied to
+//					at boot does not.  ProfPlace() decides which functions go there and
+//					writes ramfuncs.h, the file of CODE_SECTION pragmas every source
+//					file includes for its own functions (RAMFUNCS_xxx tag).
+//
+//					The candidates are the functions in profTable[], C functions and the
+//					assembly kernels of subs.asm (file tag PROF_ASM).  Functions the host
+//					build runs count their calls with PROF() (main.h); run a capture
+//					through the receiver (processReadSamples() or GoldenCheck()) between
+//					ProfReset() and ProfPlace(), and the counts per receive sample give
+//					their calls per second on the target.  Interrupt and MainLoop()
+//					functions that the host does not run have their target rate in the
+//					table.  The sizes come from the linker map of the release build
+//					(GLOBAL SYMBOLS sorted by address).
+//
+//					Flash stalls cost about the same per instruction fetched wherever it
+//					is, so the gain per RAM word is the call rate.  The functions are
+//					placed by call rate, highest first, as long as they fit in
+//					uRamWords.  PROF_PINNED functions (InitFlash(), which must run from
+//					RAM) always go first.
+//
+//					C functions get a CODE_SECTION pragma in the block of their file.
+//					An assembly kernel gets RAMFUNCS_ASM_<name> set to 1 or 0 at the top of
+//					ramfuncs.h, which subs.asm reads with .cdecls to pick its section.
+//					Only the kernel version KERNEL_IMPL links has a size in the map; the
+//					others are left out.
+//
+//					This is a manual step, not part of the build; run it again after
+//					changes to the hot code:
+//						1.	build the release configuration (writes the map)
+//						2.	in the host build: ProfReset(), run a capture through the
+//							receiver, then ProfPlace(PROF_MAP_FILE, "ramfuncs.h", 0x2000)
+//							(pMapFile = 0 also takes PROF_MAP_FILE)
+//						3.	rebuild the release configuration with the new ramfuncs.h
+//
+//					The release build then copies exactly the section to RAM: BootCopy()
+//					takes its addresses from the linker symbols RamfuncsLoadStart,
+//					RamfuncsLoadEnd and RamfuncsRunStart (EzDSP_FLASH_lnk.cmd).
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Assembly kernels as candidates (PROF_ASM); map path default.
+//==========================================================================================
+
+#include "main.h"
+
+#ifdef MEX_COMPILE
+
+#include <stdio.h>						// fopen(), fgets(), fprintf()
+#include <string.h>						// strcmp(), memset()
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	PROF_NONE			0xFFFF		// not counted on the host: fixed rate
+#define	PROF_PINNED			0xFFFE		// always in RAM
+#define	PROF_MAP_SYMBOLS	4096		// symbols read from the map
+#define	PROF_MAX_WORDS		0x800		// longer "functions" are gaps in the map
+#define	PROF_ASM			"ASM"		// file tag of the subs.asm kernels
+#define	PROF_MAP_FILE		".\\Release\\PLC.map"	// map of the release build
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	const char		*pName;			// function (map symbol without the leading _)
+	const char		*pFile;			// RAMFUNCS_xxx tag of its source file, 0 = own pragma
+	u16				uProf;			// PROF_xxx counter, PROF_NONE or PROF_PINNED
+	double			dRate;			// calls per second on the target when not counted
+}	profFunc;
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u32		ulProfCalls[PROF_FUNCS];			// Calls counted by PROF()
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+static const profFunc profTable[] =
+{
+	{"InitFlash",			0,				PROF_PINNED,			0},
+	{"adc_isr",				"TRANSMIT_NEW",	PROF_NONE,				RX_Sampling},
+	{"SmoothADCResults",	PROF_ASM,		PROF_NONE,				RX_Sampling},	// KERNEL_ASM
+	{"SmoothADCResultsC",	"KERNELS",		PROF_NONE,				RX_Sampling},
+	{"SmoothADCResultsI",	"KERNELS",		PROF_NONE,				RX_Sampling},
+	{"AdcFrontEnd",			"ADCFRONT",		PROF_NONE,				RX_Sampling},
+	{"ImpulseBlank",		"ADCFRONT",		PROF_NONE,				RX_Sampling},
+	{"ZcDetect",			"MAINS",		PROF_NONE,				RX_Sampling},
+	{"ArmAllSensors",		"SENSOR",		PROF_NONE,				RX_Sampling},
+	{"ScanSample",			"SCAN",			PROF_NONE,				RX_Sampling},	// while scanning
+	{"MainLoop",			"MAIN",			PROF_NONE,				RX_Sampling},	// per pass
+	{"SchedRun",			"SCHED",		PROF_NONE,				RX_Sampling},
+	{"SchedCycles",			"SCHED",		PROF_NONE,				RX_Sampling/4},
+	{"LoadTick",			"LOAD",			PROF_NONE,				RX_Sampling},
+	{"HandleUART",			"UART",			PROF_NONE,				RX_Sampling},
+	{"ISRTimer0",			"MAIN",			PROF_NONE,				TINTS_PER_SEC},
+	{"ExtractNextTxBit",	"TRANSMIT_NEW",	PROF_NONE,				RX_Sampling/TX_BIT_COUNT},	// while sending
+	{"SetPWMPolarity",		"TRANSMIT_NEW",	PROF_NONE,				RX_Sampling/TX_BIT_COUNT},
+	{"receive",				"DATADET_NEW",	PROF_RECEIVE,			0},
+	{"RxDemod",				"ADCFRONT",		PROF_RXDEMOD,			0},
+	{"RxQualityLatch",		"DATADET_NEW",	PROF_RXQUALITYLATCH,	0},
+	{"Log2Q1",				"DATADET_NEW",	PROF_LOG2Q1,			0},
+	{"reset_to_BitSync",	"DATADET_NEW",	PROF_RESET_TO_BITSYNC,	0},
+	{"ProcessRxPlcMsg",		"DATADET_NEW",	PROF_PROCESSRXPLCMSG,	0},
+	{"CalcCRC",				"CRC",			PROF_CALCCRC,			0},
+};
+#define	PROF_TABLE_LEN		(sizeof(profTable)/sizeof(profTable[0]))
+
+static u32		ulProfAddr[PROF_MAP_SYMBOLS];	// symbol addresses from the map
+
+
+//==========================================================================================
+// Function:		ProfReset()
+//
+// Description: 	Clear the call counts.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ProfReset(void)
+{
+	memset(ulProfCalls, 0, sizeof(ulProfCalls));
+}
+
+
+//==========================================================================================
+// Function:		ProfRate()
+//
+// Description: 	Calls per second on the target of profTable[uEntry].  Counted calls
+//					are scaled by the receive samples (calls of receive()).
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static double ProfRate(u16 uEntry)
+{
+	const profFunc	*pFunc = &profTable[uEntry];
+
+	if (pFunc->uProf == PROF_PINNED)
+		return (1e12);
+	if (pFunc->uProf == PROF_NONE)
+		return (pFunc->dRate);
+	if (ulProfCalls[PROF_RECEIVE] == 0)
+		return (0);
+	return ((double)ulProfCalls[pFunc->uProf] * RX_Sampling / ulProfCalls[PROF_RECEIVE]);
+}
+
+
+//==========================================================================================
+// Function:		ProfSizes()
+//
+// Description: 	Read the function sizes (words) from a linker map: each listed
+//					function ends where the next symbol starts.  upSize[] gets 0 for
+//					functions not in the map.  Returns False if the map cannot be read.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static u16 ProfSizes(const char *pMapFile, u16 *upSize)
+{
+	FILE	*pF;
+	char	cLine[256];
+	char	cName[128];
+	u32		ulFuncAddr[PROF_TABLE_LEN];
+	u32		ulSyms = 0;
+	u32		ulAddr, ulNext, n;
+	u16		i;
+
+	pF = fopen(pMapFile, "r");
+	if (pF == 0)
+		return (False);
+
+	memset(ulFuncAddr, 0xFF, sizeof(ulFuncAddr));
+	while (fgets(cLine, sizeof(cLine), pF) != 0)
+	{
+		if ((sscanf(cLine, "%lx %127s", &ulAddr, cName) != 2) || (cName[0] != '_'))
+			continue;
+		if (ulSyms < PROF_MAP_SYMBOLS)
+			ulProfAddr[ulSyms++] = ulAddr;
+		for (i=0; i<PROF_TABLE_LEN; i++)
+		{
+			if (strcmp(&cName[1], profTable[i].pName) == 0)
+				ulFuncAddr[i] = ulAddr;
+		}
+	}
+	fclose(pF);
+
+	for (i=0; i<PROF_TABLE_LEN; i++)
+	{
+		upSize[i] = 0;
+		if (ulFuncAddr[i] == 0xFFFFFFFF)
+			continue;
+		ulNext = 0xFFFFFFFF;
+		for (n=0; n<ulSyms; n++)
+		{
+			if ((ulProfAddr[n] > ulFuncAddr[i]) && (ulProfAddr[n] < ulNext))
+				ulNext = ulProfAddr[n];
+		}
+		if (ulNext - ulFuncAddr[i] <= PROF_MAX_WORDS)
+			upSize[i] = (u16)(ulNext - ulFuncAddr[i]);
+	}
+	return (True);
+}
+
+
+//==========================================================================================
+// Function:		ProfPlace()
+//
+// Description: 	Choose the functions for "ramfuncs" and write pOutFile (ramfuncs.h).
+//					uRamWords is the RAM the section may use.  pMapFile = 0 reads
+//					PROF_MAP_FILE.  Prints the choice and returns the words placed, 0 if
+//					the map cannot be read.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			RAMFUNCS_ASM_xxx switches for the subs.asm kernels.
+//==========================================================================================
+u16 ProfPlace(const char *pMapFile, const char *pOutFile, u16 uRamWords)
+{
+	FILE	*pF;
+	u16		upSize[PROF_TABLE_LEN];
+	u16		uOrder[PROF_TABLE_LEN];
+	u16		uPlaced[PROF_TABLE_LEN];
+	u16		uUsed = 0;
+	u16		uTmp;
+	u16		i, j;
+
+	if (pMapFile == 0)
+		pMapFile = PROF_MAP_FILE;
+	if (ProfSizes(pMapFile, upSize) != True)
+	{
+		mexPrintf("prof: cannot read %s\n", pMapFile);
+		return (0);
+	}
+
+	//---- highest call rate first ---------------------------
+	for (i=0; i<PROF_TABLE_LEN; i++)
+		uOrder[i] = i;
+	for (i=1; i<PROF_TABLE_LEN; i++)
+	{
+		for (j=i; (j > 0) && (ProfRate(uOrder[j]) > ProfRate(uOrder[j-1])); j--)
+		{
+			uTmp = uOrder[j];
+			uOrder[j] = uOrder[j-1];
+			uOrder[j-1] = uTmp;
+		}
+	}
+
+	//---- fill the RAM ----------------------------------------
+	memset(uPlaced, 0, sizeof(uPlaced));
+	for (i=0; i<PROF_TABLE_LEN; i++)
+	{
+		j = uOrder[i];
+		if ((upSize[j] == 0) || (ProfRate(j) <= 0))
+			continue;							// not linked, or never called
+		if (uUsed + upSize[j] > uRamWords)
+			continue;
+		uPlaced[j] = True;
+		uUsed += upSize[j];
+	}
+
+	for (i=0; i<PROF_TABLE_LEN; i++)
+	{
+		j = uOrder[i];
+		mexPrintf("prof: %-20s %10.0f calls/s %5d words  %s\n", profTable[j].pName,
+			(profTable[j].uProf == PROF_PINNED) ? 0.0 : ProfRate(j), upSize[j],
+			uPlaced[j] ? "RAM" : "flash");
+	}
+	mexPrintf("prof: %d of %d words of RAM used\n", uUsed, uRamWords);
+
+	//---- ramfuncs.h --------------------------------------------
+	pF = fopen(pOutFile, "w");
+	if (pF == 0)
+	{
+		mexPrintf("prof: cannot write %s\n", pOutFile);
+		return (0);
+	}
+	fprintf(pF, "//==========================================================================================\n");
+	fprintf(pF, "// Filename:\t\tramfuncs.h\n");
+	fprintf(pF, "//\n");
+	fprintf(pF, "// Description:\t\tFunctions run from RAM (\"ramfuncs\" section), one block per source\n");
+	fprintf(pF, "//\t\t\t\t\tfile.  Each file defines its RAMFUNCS_xxx tag and includes this file.\n");
+	fprintf(pF, "//\n");
+	fprintf(pF, "//\t\t\t\t\tWritten by ProfPlace() (prof.c) from %s, %d of %d words.\n", pMapFile, uUsed, uRamWords);
+	fprintf(pF, "//\t\t\t\t\tChange the candidates in prof.c and run it again rather than\n");
+	fprintf(pF, "//\t\t\t\t\tediting this file.\n");
+	fprintf(pF, "//\n");
+	fprintf(pF, "// Copyright (C) 2005 Texas Instruments Incorporated\n");
+	fprintf(pF, "// Texas Instruments Proprietary Information\n");
+	fprintf(pF, "// Use subject to terms and conditions of TI Software License Agreement\n");
+	fprintf(pF, "//==========================================================================================\n");
+
+	fprintf(pF, "\n//---- subs.asm kernels, read with .cdecls: 1 = \"ramfuncs\", 0 = .text\n");
+	for (i=0; i<PROF_TABLE_LEN; i++)
+	{
+		if ((profTable[i].pFile != 0) && (strcmp(profTable[i].pFile, PROF_ASM) == 0))
+			fprintf(pF, "#define\tRAMFUNCS_ASM_%s\t%d\t// %.0f calls/s, %d words\n",
+				profTable[i].pName, uPlaced[i] ? 1 : 0, ProfRate(i), upSize[i]);
+	}
+
+	fprintf(pF, "\n#if defined(DSP_COMPILE) && !defined(__cplusplus)\n");
+	for (i=0; i<PROF_TABLE_LEN; i++)
+	{
+		if ((profTable[i].pFile == 0) || (strcmp(profTable[i].pFile, PROF_ASM) == 0))
+			continue;
+		for (j=0; j<i; j++)						// first entry of its file?
+		{
+			if ((profTable[j].pFile != 0) && (strcmp(profTable[j].pFile, profTable[i].pFile) == 0))
+				break;
+		}
+		if (j < i)
+			continue;
+
+		fprintf(pF, "\n#ifdef RAMFUNCS_%s\n", profTable[i].pFile);
+		for (j=i; j<PROF_TABLE_LEN; j++)
+		{
+			if ((profTable[j].pFile == 0) || (strcmp(profTable[j].pFile, profTable[i].pFile) != 0))
+				continue;
+			fprintf(pF, "%s\t#pragma CODE_SECTION(%s, \"ramfuncs\");\t// %.0f calls/s, %d words\n",
+				uPlaced[j] ? "" : "//", profTable[j].pName, ProfRate(j), upSize[j]);
+		}
+		fprintf(pF, "#endif\n");
+	}
+	fprintf(pF, "\n#endif\n");
+	fclose(pF);
+
+	return (uUsed);
+}
+
+#endif	// MEX_COMPILE
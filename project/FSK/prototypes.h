@@ -24,8 +24,38 @@
 #include "DSP280x_GlobalPrototypes.h"
 #include "main.h"
 
+// adcfront.c
+extern s16 AdcFrontEnd(const u16 *upResult);
+extern s16 ImpulseBlank(s16 sSample);
+extern void BlankReset(void);
+extern s16 RxDemod(s16 sSample);
+extern void RxDemodReset(void);
+#ifdef MEX_COMPILE
+extern u16 BlankCheck(void);
+#endif
+
+// arq.c
+extern void ArqInit(void);
+extern u16 ArqQueue(u16 uDest, const u16 *upCmd, u16 uLen);
+extern u16 ArqLow(u16 uDest);
+extern u16 ArqService(void);
+extern u16 CmdArqData(void);
+extern u16 CmdArqAck(void);
+
+// channel.c
+#ifdef MEX_COMPILE
+extern void ChanPreset(u16 uModel);
+extern void ChanReset(void);
+extern u32 ChanLoadNoise(const char *pFile);
+extern s16 ChanSample(s16 sClean);
+extern void ChanResponse(void);
+#endif
+
 // command.c
 extern void TaskCommand(void);
+extern void LampControl(u16 uCmdNum, u16 uValue);
+extern u16 LampAddressed(u16 uAddr);
+extern u16 LampBatch(const u16 *upBatch, u16 uLen);
 
 // dacout.c
 extern void ConfigurePWMDAC(void);
@@ -43,8 +73,93 @@ extern void InitLampVars(void);
 // gpio.c
 extern void InitGpio(void);
 
+// fec.c
+extern void FecInit(void);
+extern void FecEncode(const u16 *upMsg, u16 uLen, u16 *upParity);
+extern u16 FecDecodeRx(u16 uCodedLen);
+#ifdef MEX_COMPILE
+extern void FecBench(u16 uFrames, u16 uLen, u16 uBurst, u16 uFlag);
+#endif
+
+// golden.c
+#ifdef MEX_COMPILE
+extern void GoldenTrace(u16 uWord);
+extern u32 GoldenRecord(const char *pInFile, const char *pOutFile);
+extern u32 GoldenCheck(const char *pGoldenFile);
+extern u32 GoldenSynth(const char *pOutFile);
+#endif
+
+// kernels.c
+extern q16 Sat16C(q32 qlX);
+extern q16 Sat16I(q32 qlX);
+extern u16 SmoothADCResultsC(void);
+extern u16 SmoothADCResultsI(void);
+extern u16 ReadProgC(u16 Address);
+extern void WriteProgC(u16 Address, u16 Data);
+extern u16 KernelCheck(u16 *upResult);
+
+// link.c
+extern void LinkInit(void);
+// LinkFind() and LinkResult() are declared in main.h, after linkEntry
+extern void LinkTxSent(u16 uAddr);
+extern void LinkAck(u16 uAddr, u16 uOk);
+extern u16 LinkTimeout(void);
+extern u16 LinkFrameLen(u16 uAddr);
+
+// load.c
+extern void LoadInit(void);
+extern void LoadReset(void);
+extern void LoadTick(void);
+
 // main.c
 extern interrupt void ISRTimer0(void);
+extern void TaskUart(void);
+extern void TaskLamp(void);
+extern void MainTasks(void);
+
+// mains.c
+extern void ZcDetect(s16 sMains);
+extern u16 ZcTxWindowOpen(void);
+extern void ZcCountRx(u16 uResult);
+
+// plcsim.c
+#ifdef MEX_COMPILE
+extern void PlcSim(u16 uNodes, u16 uFloodInterval, u16 uSeconds);
+extern void PlcSimSweep(u16 uFloodInterval, u16 uSeconds);
+#endif
+
+// memmap.c
+#ifdef MEX_COMPILE
+extern u32 MapReport(const char *pMapFile, const char *pOutFile);
+#endif
+
+// prof.c
+#ifdef MEX_COMPILE
+extern void ProfReset(void);
+extern u16 ProfPlace(const char *pMapFile, const char *pOutFile, u16 uRamWords);
+#endif
+
+// relay.c
+extern void RelayInit(void);
+extern u16 RelaySend(u16 uDest, u16 uHopLimit, const u16 *upCmd, u16 uLen);
+extern void RelayReceive(const u16 *upFrame, u16 uLen);
+extern u16 RelayService(void);
+#ifdef MEX_COMPILE
+extern void RelaySim(u16 uTrials);
+#endif
+
+// scan.c
+extern void ScanStart(u16 uBlocks);
+extern void ScanSample(s16 sSample);
+#ifdef MEX_COMPILE
+extern u16 ScanCheck(void);
+#endif
+
+// sched.c
+extern u16 SchedCycles(u32 ulStart);
+extern void SchedInit(void);
+extern u16 SchedAdd(void (*pfRun)(void), u16 (*pfReady)(void), u16 uPeriod, u16 uPriority);
+extern void SchedRun(void);
 
 // subs.asm
 u16 ReadProg(u16 Address);
@@ -59,14 +174,23 @@ extern q32	AutoCorr(void);
 extern void FillTxBuffer(u16 uUserTxMsgLen);
 extern u16 GenerateFakePLCMessage(u16	uSeed);
 extern u16 GenerateFloodPLCMessage(u16	uSeed);
+extern void SetPlcMode(u16 mode);
+extern void ExtractNextTxBit(void);
 
 // detData.c
 extern void ProcessRxPlcMsg(void);
 extern void receive(s16 ADCsample);
 extern void reset_to_BitSync(void);
+extern void ReceiveReset(void);
+extern void RxQualityLatch(void);
+extern u16 Log2Q1(u32 ulX);
+
+// bench.c
+#ifdef MEX_COMPILE
+extern u16 BenchRun(const char *pJsonFile, const char *pBaselineFile);
+#endif
 
 // crc.c
-void InitCRCtable(void);
 void AppendParityCheckBytes(u16 *pUserData, u16 numWords);
 u16 CompareParityCheckBytes(u16 *pUserData, u16 numBytes);
 u16 CalcCRC(u16 uPlcMode, u16 numBytes);
@@ -80,6 +204,7 @@ extern u16 WriteUARTValue(u16 uValue);
 
 // sensor.c
 extern void	ConfigureADCs(void);
+extern void	PowerUpADCs(void);
 extern void ReadAllSensors(u16 uWaitFlag);
 extern u16 SmoothSensor(void);
 extern void ArmAllSensors(void);
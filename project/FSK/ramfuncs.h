@@ -0,0 +1,81 @@
+//==========================================================================================
+// Filename:		ramfuncs.h
+//
+// Description:		Functions run from RAM ("ramfuncs" section), one block per source
+//					file.  Each file defines its RAMFUNCS_xxx tag and includes this file.
+//
+//					Written by ProfPlace() (prof.c) from a host profile and the linker
+//					map.  Change the candidates in prof.c and run it again rather than
+//					editing this file.  Until the first profile run it holds the
+//					functions that were placed by hand.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//==========================================================================================
+
+//---- subs.asm kernels, read with .cdecls: 1 = "ramfuncs", 0 = .text
+#define	RAMFUNCS_ASM_SmoothADCResults	1
+
+#if defined(DSP_COMPILE) && !defined(__cplusplus)
+
+#ifdef RAMFUNCS_TRANSMIT_NEW
+	#pragma CODE_SECTION(adc_isr, "ramfuncs");
+//	#pragma CODE_SECTION(ExtractNextTxBit, "ramfuncs");
+//	#pragma CODE_SECTION(SetPWMPolarity, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_KERNELS
+	#pragma CODE_SECTION(SmoothADCResultsC, "ramfuncs");
+	#pragma CODE_SECTION(SmoothADCResultsI, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_ADCFRONT
+	#pragma CODE_SECTION(AdcFrontEnd, "ramfuncs");
+	#pragma CODE_SECTION(ImpulseBlank, "ramfuncs");
+	#pragma CODE_SECTION(RxDemod, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_MAINS
+	#pragma CODE_SECTION(ZcDetect, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_SENSOR
+	#pragma CODE_SECTION(ArmAllSensors, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_SCAN
+	#pragma CODE_SECTION(ScanSample, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_MAIN
+	#pragma CODE_SECTION(MainLoop, "ramfuncs");
+	#pragma CODE_SECTION(ISRTimer0, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_SCHED
+	#pragma CODE_SECTION(SchedRun, "ramfuncs");
+	#pragma CODE_SECTION(SchedCycles, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_LOAD
+	#pragma CODE_SECTION(LoadTick, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_UART
+//	#pragma CODE_SECTION(HandleUART, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_DATADET_NEW
+	#pragma CODE_SECTION(receive, "ramfuncs");
+//	#pragma CODE_SECTION(RxQualityLatch, "ramfuncs");
+//	#pragma CODE_SECTION(Log2Q1, "ramfuncs");
+//	#pragma CODE_SECTION(reset_to_BitSync, "ramfuncs");
+//	#pragma CODE_SECTION(ProcessRxPlcMsg, "ramfuncs");
+#endif
+
+#ifdef RAMFUNCS_CRC
+//	#pragma CODE_SECTION(CalcCRC, "ramfuncs");
+#endif
+
+#endif
@@ -0,0 +1,509 @@
+//==========================================================================================
+// Filename:		relay.c
+//
+// Description:		Multi-hop repeater.
+//
+//					CMD_PLC_RELAYED sends a command to a node that may be out of direct
+//					reach.  The frame goes to PLC_ADDR_BROADCAST with the originator, a
+//					sequence number, the hops made so far and a hop limit.  Every node
+//					that hears it with a good link (rxQuality.uSnr at least RELAY_SNR_MIN)
+//					repeats it once, after a hold off of 0 to RELAY_SLOTS-1 frame times.
+//					The weaker the link, the shorter the hold off, so the node furthest
+//					from the last sender goes first.  A node that hears another node's
+//					repeat of the same frame while it is still holding off drops its own
+//					copy.  Recently seen frames are kept in a small table so every node
+//					runs and repeats a frame at most once; a node that heard the first
+//					copy too weakly may still repeat a later, stronger one, and a node
+//					whose command task was busy with the first copy runs a later one.
+//
+//					Frame (bytes):	PLC_ADDR_BROADCAST hi, lo, CMD_RELAY, originator hi, lo,
+//									seq, hops, hop limit, final dest hi, lo,
+//									command (RELAY_PAYLOAD_LEN bytes)
+//
+//					The final destination may be a node, a group or PLC_ADDR_BROADCAST.
+//					Relayed commands run like group commands (uCommandMulticast): they do
+//					not answer on the power line, since the answer has no route back.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Received frames clamped to the send buffer; commands that find the
+//					command task busy are counted and run from a later copy.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+#ifdef MEX_COMPILE
+	#include <stdlib.h>					// rand()
+#endif
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	RELAY_HDR_LEN		10			// bytes ahead of the command
+#define	RELAY_PAYLOAD_LEN	(MAX_TX_MSG_LEN - RELAY_HDR_LEN)	// command bytes per frame
+#define	RELAY_SEEN_LEN		8			// frames remembered for duplicate suppression
+#define	RELAY_SLOTS			4			// hold off slots before a repeat
+#define	RELAY_SLOT_TICKS	(PLC_FRAME_TICKS(MAX_TX_MSG_LEN) + TINTS_PER_SEC/100)	// frame + 10 ms
+#define	RELAY_SNR_MIN		12			// 18 dB (rxQuality.uSnr units of 1.5 dB)
+#define	RELAY_SNR_PER_SLOT	4			// 6 dB more SNR, one slot more hold off
+#define	RELAY_HOP_MAX		7			// highest hop limit accepted
+
+// byte offsets in upFrame[] as passed to RelayReceive() (destination stripped)
+enum {	RF_CMD, RF_ORIG_HI, RF_ORIG_LO, RF_SEQ, RF_HOPS, RF_LIMIT, RF_DEST_HI, RF_DEST_LO, RF_PAYLOAD };
+
+
+//==========================================================================================
+// Local types
+//==========================================================================================
+typedef struct
+{
+	u16				uOrig;			// originator address
+	u16				uSeq;			// originator's sequence number
+	u16				uDone;			// Flag: repeated, suppressed, or not to be repeated
+	u16				uRun;			// Flag: command run here (or sent from here)
+}	relaySeen;
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u32		ulRelayStats[RELAY_STATS_LEN/2];	// Statistics for the repeater
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+relaySeen	relaySeenTable[RELAY_SEEN_LEN];	// recently seen frames
+u16			uRelaySeenNext = 0;			// oldest entry, replaced next
+u16			uRelaySeq = 0;				// sequence number of frames sent from here
+
+u16			uRelayPending = False;		// Flag: upRelayFrame waits to be sent
+u16			upRelayFrame[MAX_TX_MSG_LEN];	// frame to send, one byte per word
+u16			uRelayLen;					// bytes in upRelayFrame
+u32			ulRelayAt;					// CpuTimer0 count when it may be sent
+u32			ulRelayDelay;				// hold off ticks
+
+
+//==========================================================================================
+// Function:		RelayInit()
+//
+// Description: 	Empty the duplicate table and the send buffer.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void RelayInit(void)
+{
+	u16		i;
+
+	for (i=0; i<RELAY_SEEN_LEN; i++)
+	{
+		relaySeenTable[i].uOrig = 0xFFFF;
+		relaySeenTable[i].uSeq = 0;
+		relaySeenTable[i].uDone = True;
+		relaySeenTable[i].uRun = True;
+	}
+	uRelaySeenNext = 0;
+	uRelayPending = False;
+	memset(ulRelayStats, 0, sizeof(ulRelayStats));
+}
+
+
+//==========================================================================================
+// Function:		RelayLookup()
+//
+// Description: 	Returns the duplicate table entry of the frame (uOrig, uSeq), or 0.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static relaySeen *RelayLookup(u16 uOrig, u16 uSeq)
+{
+	u16		i;
+
+	for (i=0; i<RELAY_SEEN_LEN; i++)
+	{
+		if ((relaySeenTable[i].uOrig == uOrig) && (relaySeenTable[i].uSeq == uSeq))
+			return (&relaySeenTable[i]);
+	}
+	return (0);
+}
+
+
+//==========================================================================================
+// Function:		RelayRemember()
+//
+// Description: 	Enter the frame (uOrig, uSeq) into the duplicate table in place of the
+//					oldest entry.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+static relaySeen *RelayRemember(u16 uOrig, u16 uSeq)
+{
+	relaySeen	*pSeen;
+
+	pSeen = &relaySeenTable[uRelaySeenNext];
+	pSeen->uOrig = uOrig;
+	pSeen->uSeq = uSeq;
+	pSeen->uDone = False;
+	pSeen->uRun = False;
+	if (++uRelaySeenNext >= RELAY_SEEN_LEN)
+		uRelaySeenNext = 0;
+	return (pSeen);
+}
+
+
+//==========================================================================================
+// Function:		RelaySend()
+//
+// Description: 	Start a relay frame from this node.  upCmd holds uLen command bytes,
+//					one per word.  Returns the sequence number, or RELAY_BUSY if a frame
+//					is still waiting to be sent.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 RelaySend(u16 uDest, u16 uHopLimit, const u16 *upCmd, u16 uLen)
+{
+	u16			i;
+	relaySeen	*pSeen;
+
+	if (uRelayPending)
+		return (RELAY_BUSY);
+
+	uLen = Min(uLen, RELAY_PAYLOAD_LEN);
+	upRelayFrame[0] = PLC_ADDR_BROADCAST >> 8;
+	upRelayFrame[1] = PLC_ADDR_BROADCAST & 0x00FF;
+	upRelayFrame[2+RF_CMD]     = CMD_RELAY;
+	upRelayFrame[2+RF_ORIG_HI] = uMyAddress >> 8;
+	upRelayFrame[2+RF_ORIG_LO] = uMyAddress & 0x00FF;
+	upRelayFrame[2+RF_SEQ]     = uRelaySeq;
+	upRelayFrame[2+RF_HOPS]    = 0;
+	upRelayFrame[2+RF_LIMIT]   = Min(uHopLimit, RELAY_HOP_MAX);
+	upRelayFrame[2+RF_DEST_HI] = uDest >> 8;
+	upRelayFrame[2+RF_DEST_LO] = uDest & 0x00FF;
+	for (i=0; i<uLen; i++)
+	{
+		upRelayFrame[RELAY_HDR_LEN+i] = upCmd[i] & 0x00FF;
+	}
+	uRelayLen = RELAY_HDR_LEN + uLen;
+
+	pSeen = RelayRemember(uMyAddress, uRelaySeq);	// ignore it when it comes back
+	pSeen->uDone = True;
+	pSeen->uRun = True;
+	uRelaySeq = (uRelaySeq + 1) & 0x00FF;
+
+	ulRelayAt = CpuTimer0.InterruptCount;
+	ulRelayDelay = 0;
+	uRelayPending = True;
+	ulRelayStats[RELAY_ORIGINATED]++;
+
+	return (upRelayFrame[2+RF_SEQ]);
+}
+
+
+//==========================================================================================
+// Function:		RelayRun()
+//
+// Description: 	Run the command of a relay frame if it is for this node and has not
+//					run yet.  If the command task is still busy the frame stays not run,
+//					so a later copy of it (another node's repeat) can still deliver it.
+//
+// Revision History:
+// 19Oct26			New function, from RelayReceive().
+//==========================================================================================
+static void RelayRun(relaySeen *pSeen, const u16 *upFrame, u16 uLen, u16 uDest)
+{
+	u16		i;
+
+	if ( pSeen->uRun || !LampAddressed(uDest) )
+		return;
+	if (uCommandActive != 0)
+	{
+		ulRelayStats[RELAY_CMD_BUSY]++;
+		return;
+	}
+
+	memset(upCommand, 0, COMMAND_PARMS*sizeof(u16));
+	for (i=RF_PAYLOAD; (i<uLen) && (i-RF_PAYLOAD < COMMAND_PARMS); i++)
+	{
+		upCommand[i-RF_PAYLOAD] = upFrame[i];
+	}
+	uCommandMulticast = True;
+	uCommandActive = 1;
+	ulRelayStats[RELAY_DELIVERED]++;
+	pSeen->uRun = True;
+}
+
+
+//==========================================================================================
+// Function:		RelayReceive()
+//
+// Description: 	Called by ProcessRxPlcMsg() with a CMD_RELAY frame (destination bytes
+//					stripped, uLen bytes, one per word).  Runs the command if it is for
+//					this node and schedules a repeat if the frame may go further.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			uLen clamped to upRelayFrame; command run by RelayRun().
+//==========================================================================================
+void RelayReceive(const u16 *upFrame, u16 uLen)
+{
+	u16			i;
+	u16			uOrig;
+	u16			uSeq;
+	u16			uHops;
+	u16			uDest;
+	relaySeen	*pSeen;
+
+	if (uLen <= RF_PAYLOAD)
+		return;
+	uLen = Min(uLen, MAX_TX_MSG_LEN - 2);	// repeated behind the 2 address bytes
+
+	uOrig = (upFrame[RF_ORIG_HI] << 8) | upFrame[RF_ORIG_LO];
+	uSeq  = upFrame[RF_SEQ];
+	uHops = upFrame[RF_HOPS];
+	uDest = (upFrame[RF_DEST_HI] << 8) | upFrame[RF_DEST_LO];
+
+	pSeen = RelayLookup(uOrig, uSeq);
+	if (pSeen != 0)
+	{
+		//---- duplicate: drop my repeat if another node was first ----
+		ulRelayStats[RELAY_DUPLICATES]++;
+		if ( uRelayPending && (uHops >= upRelayFrame[2+RF_HOPS]) &&
+			 (uOrig == ((upRelayFrame[2+RF_ORIG_HI] << 8) | upRelayFrame[2+RF_ORIG_LO])) &&
+			 (uSeq == upRelayFrame[2+RF_SEQ]) )
+		{
+			uRelayPending = False;
+			ulRelayStats[RELAY_SUPPRESSED]++;
+		}
+		RelayRun(pSeen, upFrame, uLen, uDest);	// not run yet if the command task was busy
+		if (pSeen->uDone)
+			return;
+	}
+	else
+	{
+		pSeen = RelayRemember(uOrig, uSeq);
+
+		//---- for me: run it like a group command -------------
+		RelayRun(pSeen, upFrame, uLen, uDest);
+		if (uDest == uMyAddress)
+		{
+			pSeen->uDone = True;		// reached the end
+			return;
+		}
+	}
+
+	//---- repeat it ------------------------------------------
+	if ( (uHops >= upFrame[RF_LIMIT]) || (rxQuality.uSnr < RELAY_SNR_MIN) )
+		return;
+	if (uRelayPending)
+	{
+		ulRelayStats[RELAY_DROPPED]++;	// still holding the last one
+		return;
+	}
+
+	upRelayFrame[0] = PLC_ADDR_BROADCAST >> 8;
+	upRelayFrame[1] = PLC_ADDR_BROADCAST & 0x00FF;
+	for (i=0; i<uLen; i++)
+	{
+		upRelayFrame[2+i] = upFrame[i];
+	}
+	upRelayFrame[2+RF_HOPS] = uHops + 1;
+	uRelayLen = 2 + uLen;
+
+	ulRelayAt = CpuTimer0.InterruptCount;
+	ulRelayDelay = (u32)Min(RELAY_SLOTS-1, (rxQuality.uSnr - RELAY_SNR_MIN) / RELAY_SNR_PER_SLOT)
+				   * RELAY_SLOT_TICKS;
+	uRelayPending = True;
+	pSeen->uDone = True;
+}
+
+
+//==========================================================================================
+// Function:		RelayService()
+//
+// Description: 	Called from MainLoop().  Moves a relay frame whose hold off is over into
+//					txUserDataArray.  Returns its length, or 0 if nothing was queued.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 RelayService(void)
+{
+	u16		i;
+
+	if ( !uRelayPending || (uTxMsgPending == True) || (plcMode == TX_MODE) )
+		return (0);
+	if ((CpuTimer0.InterruptCount - ulRelayAt) < ulRelayDelay)
+		return (0);
+
+	for (i=0; i<uRelayLen; i++)
+	{
+		txUserDataArray[i] = upRelayFrame[i];
+	}
+	uRelayPending = False;
+	uTxMsgPending = True;
+	if (upRelayFrame[2+RF_HOPS] > 0)
+		ulRelayStats[RELAY_FORWARDED]++;
+
+	return (uRelayLen);
+}
+
+
+#ifdef MEX_COMPILE
+//==========================================================================================
+// Function:		RelaySim()
+//
+// Description: 	Host simulation of the repeater rules on a line of RELAY_SIM_NODES nodes
+//					one unit apart.  Node 0 sends a frame to node d.  The SNR of a link
+//					falls with distance plus a random spread; a frame is received if the
+//					SNR is at least RELAY_SIM_SNR_RX and only one sender in reach is on
+//					the air in that frame time.  Prints the delivery rate for each
+//					distance and hop limit over uTrials frames.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+#define	RELAY_SIM_NODES		12
+#define	RELAY_SIM_SNR_RX	8			// 12 dB to decode a frame
+#define	RELAY_SIM_SNR_NEAR	36			// SNR at zero distance
+#define	RELAY_SIM_SNR_STEP	14			// SNR lost per unit of distance
+#define	RELAY_SIM_SPREAD	7			// random +- spread
+
+static s16 RelaySimSnr(s16 sDist)
+{
+	if (sDist < 0)
+		sDist = -sDist;
+	return (RELAY_SIM_SNR_NEAR - RELAY_SIM_SNR_STEP*sDist
+			+ (s16)(rand() % (2*RELAY_SIM_SPREAD+1)) - RELAY_SIM_SPREAD);
+}
+
+void RelaySim(u16 uTrials)
+{
+	s16		n, r, d;
+	u16		uLimit, uTrial;
+	u16		uDelivered;
+	u16		uSent;
+	u16		uTime, uNext;
+	u16		uSenders;
+	s16		sFrom;
+	s16		sSnr;
+	u16		uSeen[RELAY_SIM_NODES];
+	u16		uDone[RELAY_SIM_NODES];			// Flag: repeated, suppressed or at the end
+	u16		uPending[RELAY_SIM_NODES];		// Flag: holding a repeat
+	u16		uAt[RELAY_SIM_NODES];			// frame time of the repeat
+	u16		uHops[RELAY_SIM_NODES];			// hop count of the repeat
+	u16		uRxHops;
+
+	mexPrintf("relay delivery %% (frames sent per delivery), %d trials\n", uTrials);
+	mexPrintf("dist ");
+	for (uLimit=0; uLimit<=4; uLimit++)
+		mexPrintf("   limit %d    ", uLimit);
+	mexPrintf("\n");
+
+	for (d=1; d<RELAY_SIM_NODES; d++)
+	{
+		mexPrintf("%4d ", d);
+		for (uLimit=0; uLimit<=4; uLimit++)
+		{
+			uDelivered = 0;
+			uSent = 0;
+			for (uTrial=0; uTrial<uTrials; uTrial++)
+			{
+				memset(uSeen, 0, sizeof(uSeen));
+				memset(uDone, 0, sizeof(uDone));
+				memset(uPending, 0, sizeof(uPending));
+				uSeen[0] = True;
+				uDone[0] = True;
+				uPending[0] = True;
+				uAt[0] = 0;
+				uHops[0] = 0;
+
+				for (;;)
+				{
+					//---- next frame time with a sender -----------
+					uNext = 0xFFFF;
+					for (n=0; n<RELAY_SIM_NODES; n++)
+					{
+						if (uPending[n] && (uAt[n] < uNext))
+							uNext = uAt[n];
+					}
+					if (uNext == 0xFFFF)
+						break;
+					uTime = uNext;
+
+					//---- each listener hears at most one sender ------
+					for (r=0; r<RELAY_SIM_NODES; r++)
+					{
+						if (uPending[r] && (uAt[r] == uTime))
+							continue;			// on the air itself
+						uSenders = 0;
+						sFrom = -1;
+						sSnr = 0;
+						for (n=0; n<RELAY_SIM_NODES; n++)
+						{
+							s16 sLink;
+							if (!uPending[n] || (uAt[n] != uTime))
+								continue;
+							sLink = RelaySimSnr(n - r);
+							if (sLink >= RELAY_SIM_SNR_RX)
+							{
+								uSenders++;
+								sFrom = n;
+								sSnr = sLink;
+							}
+						}
+						if (uSenders != 1)
+							continue;			// nothing, or a collision
+
+						uRxHops = uHops[sFrom];
+						if (uSeen[r])
+						{
+							if (uPending[r] && (uAt[r] > uTime) && (uRxHops >= uHops[r]))
+								uPending[r] = False;		// suppressed
+							if (uDone[r])
+								continue;
+						}
+						uSeen[r] = True;
+						if (r == d)
+						{
+							uDone[r] = True;
+							continue;
+						}
+						if ((uRxHops < uLimit) && (sSnr >= RELAY_SNR_MIN))
+						{
+							uPending[r] = True;
+							uDone[r] = True;
+							uHops[r] = uRxHops + 1;
+							uAt[r] = uTime + 1 + Min(RELAY_SLOTS-1, (sSnr - RELAY_SNR_MIN) / RELAY_SNR_PER_SLOT);
+						}
+					}
+
+					//---- senders are done ---------------------
+					for (n=0; n<RELAY_SIM_NODES; n++)
+					{
+						if (uPending[n] && (uAt[n] == uTime))
+						{
+							uPending[n] = False;
+							uSent++;
+						}
+					}
+				}
+				if (uSeen[d])
+					uDelivered++;
+			}
+			mexPrintf("  %5.1f (%4.1f) ", 100.0 * uDelivered / uTrials,
+				uDelivered ? (double)uSent / uDelivered : 0.0);
+		}
+		mexPrintf("\n");
+	}
+}
+#endif
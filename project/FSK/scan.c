@@ -0,0 +1,219 @@
+//==========================================================================================
+// Filename:		scan.c
+//
+// Description:		Line spectrum / noise floor scanner.
+//
+//					While the receiver is idle (FIND_BITSYNC, RX_MODE) each ADC sample is
+//					run through a bank of SCAN_BINS Goertzel filters.  The power of each
+//					bin is summed over SCAN_N sample blocks and read back with CMD_SCAN.
+//
+//					The receiver samples at RX_Sampling (60.42 kHz), below the carriers,
+//					so the band from RX_Sampling to 1.5*RX_Sampling (60.4 - 90.6 kHz) is
+//					seen aliased.  The bins assume the coupling circuit removes the band
+//					below RX_Sampling, which would otherwise fold onto the same bins.
+//
+//					ScanCheck() (host build) runs a full-scale tone through each bin.
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Goertzel products widened to 48/64 bits; ScanCheck() added.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+#ifdef MEX_COMPILE
+#include <math.h>						// cos(), floor() for ScanCheck()
+#endif
+
+#define	RAMFUNCS_SCAN						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	SCAN_N				128			// samples per Goertzel block (bin width ~470 Hz)
+#define	SCAN_COEFF_SCALE	13			// sScanCoeff[] is 2*cos(w) in Q13
+#define	SCAN_PWR_SHIFT		16			// block power is below (SCAN_N*32768)^2 = 2^44;
+										// 2^28 after the shift, so SCAN_MAX_BLOCKS fit in u32
+
+//---- coeff * state >> SCAN_COEFF_SCALE with a 48-bit product ----------
+#ifdef DSP_COMPILE
+	#define	SCAN_MPY(C,Q)		__qmpy32by16((Q), (C), SCAN_COEFF_SCALE)
+#else
+	#define	SCAN_MPY(C,Q)		((s32)(((s64)(C) * (Q)) >> SCAN_COEFF_SCALE))
+#endif
+
+const u16 uScanFreq[SCAN_BINS] = 		// bin centre frequency, 10 Hz units
+{										// includes TX_FREQ_m (63.3 kHz) and TX_FREQ_s (74 kHz)
+	6100, 6200, 6330, 6450, 6600, 6800, 7000, 7200,
+	7400, 7550, 7700, 7900, 8100, 8400, 8700, 9000
+};
+
+const s16 sScanCoeff[SCAN_BINS] = 		// 2*cos(2*pi*f/RX_Sampling) in Q13 for uScanFreq[]
+{
+	16354,  16164,  15655,  14932,  13703,  11553,   8905,   5874,
+	 2586,     44,  -2502,  -5791,  -8831, -12641, -15230, -16349
+};
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+u16		uScanActive = False;			// Flag: scanner is collecting blocks
+u16		uScanBlocksDone = 0;			// number of blocks summed into ulScanPower[]
+u32		ulScanPower[SCAN_BINS];			// power per bin, summed over the blocks
+
+
+//==========================================================================================
+// Local variables
+//==========================================================================================
+u16		uScanBlocksLeft = 0;			// blocks still to collect
+u16		uScanCnt = 0;					// samples into the current block
+s32		lScanQ1[SCAN_BINS];				// Goertzel states
+s32		lScanQ2[SCAN_BINS];
+
+
+//==========================================================================================
+// Function:		ScanStart()
+//
+// Description: 	Clear the results and start collecting uBlocks blocks.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void ScanStart(u16 uBlocks)
+{
+	uScanActive = False;				// keep adc_isr() out while clearing
+
+	memset(ulScanPower, 0, sizeof(ulScanPower));
+	memset(lScanQ1, 0, sizeof(lScanQ1));
+	memset(lScanQ2, 0, sizeof(lScanQ2));
+	uScanCnt = 0;
+	uScanBlocksDone = 0;
+	uScanBlocksLeft = Saturate(uBlocks, 1, SCAN_MAX_BLOCKS);
+
+	uScanActive = True;
+}
+
+
+//==========================================================================================
+// Function:		ScanSample()
+//
+// Description: 	Called by adc_isr() with each raw receive sample while uScanActive.
+//					A block is only used if the receiver stayed idle for all of it.
+//
+//					Goertzel:	q0 = x + 2cos(w)*q1 - q2
+//					Power:		q1^2 + q2^2 - 2cos(w)*q1*q2
+//
+//					The states reach about 1400 times the input over a block for the
+//					bins next to 0 and Fs/2, so a full-scale sample needs 27 bits.  The
+//					input is not scaled; the coefficient products are taken 48 bits
+//					wide and the power 64 bits wide.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Products widened: coeff * state and the power overflowed s32 for
+//					strong tones and the wrapped power was dropped as negative.
+//==========================================================================================
+void ScanSample(s16 sSample)
+{
+	u16		i;
+	s32		lQ0;
+	s64		llPower;
+
+	//---- only listen while idle ------------------
+	if ((uRxMode != FIND_BITSYNC) || (plcMode != RX_MODE))
+	{
+		if (uScanCnt != 0)
+		{
+			memset(lScanQ1, 0, sizeof(lScanQ1));	// discard the partial block
+			memset(lScanQ2, 0, sizeof(lScanQ2));
+			uScanCnt = 0;
+		}
+		return;
+	}
+
+	for (i=0; i<SCAN_BINS; i++)
+	{
+		lQ0 = sSample + SCAN_MPY(sScanCoeff[i], lScanQ1[i]) - lScanQ2[i];
+		lScanQ2[i] = lScanQ1[i];
+		lScanQ1[i] = lQ0;
+	}
+
+	//---- end of block: add the power of each bin ---------
+	if (++uScanCnt >= SCAN_N)
+	{
+		for (i=0; i<SCAN_BINS; i++)
+		{
+			llPower = (s64)lScanQ1[i] * lScanQ1[i] + (s64)lScanQ2[i] * lScanQ2[i]
+				- (s64)SCAN_MPY(sScanCoeff[i], lScanQ1[i]) * lScanQ2[i];
+			if (llPower > 0)				// only the coefficient rounding goes below 0
+				ulScanPower[i] += (u32)(llPower >> SCAN_PWR_SHIFT);
+
+			lScanQ1[i] = 0;
+			lScanQ2[i] = 0;
+		}
+		uScanCnt = 0;
+		uScanBlocksDone++;
+
+		if (--uScanBlocksLeft == 0)
+			uScanActive = False;
+	}
+}
+
+
+#ifdef MEX_COMPILE
+//==========================================================================================
+// Function:		ScanCheck()
+//
+// Description: 	Host check of the scanner: a full-scale tone on each bin frequency
+//					in turn must give its largest power in that bin.  Prints the bins
+//					that fail and returns their number.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 ScanCheck(void)
+{
+	u16		uSaveRxMode = uRxMode;
+	u16		uSavePlcMode = plcMode;
+	u16		uBad = 0;
+	u16		uPeak;
+	u16		i, k, n;
+	double	dW;
+
+	uRxMode = FIND_BITSYNC;				// the scanner only listens while idle
+	plcMode = RX_MODE;
+
+	for (k=0; k<SCAN_BINS; k++)
+	{
+		dW = 2.0 * 3.14159265358979 * uScanFreq[k] * 10.0 / RX_Sampling;
+		ScanStart(SCAN_MAX_BLOCKS);
+		for (n=0; n<SCAN_N*SCAN_MAX_BLOCKS; n++)
+			ScanSample((s16)floor(32767.0 * cos(dW * n) + 0.5));
+
+		uPeak = 0;
+		for (i=1; i<SCAN_BINS; i++)
+		{
+			if (ulScanPower[i] > ulScanPower[uPeak])
+				uPeak = i;
+		}
+		if ((uPeak != k) || (uScanBlocksDone != SCAN_MAX_BLOCKS))
+		{
+			mexPrintf("scan: %u0 Hz tone peaks in bin %u (%u0 Hz)\n", uScanFreq[k], uPeak,
+				uScanFreq[uPeak]);
+			uBad++;
+		}
+	}
+
+	uRxMode = uSaveRxMode;
+	plcMode = uSavePlcMode;
+	mexPrintf("scan: %u of %u bins wrong\n", uBad, SCAN_BINS);
+	return (uBad);
+}
+#endif
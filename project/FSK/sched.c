@@ -0,0 +1,177 @@
+//==========================================================================================
+// Filename:		sched.c
+//
+// Description:		Cooperative task scheduler for MainLoop().
+//
+//					MainLoop() wakes once per receive sample (ADC interrupt) and calls
+//					SchedRun().  Each task in schedTable[] has
+//
+//					- a period in receive samples (1 = every sample),
+//					- an optional ready function: a due task that has no work stays due
+//					  and runs at the first sample it is ready, instead of waiting a
+//					  whole period again,
+//					- a priority.  The table is kept in priority order and SchedRun()
+//					  goes down it once per sample.
+//
+//					MainLoop() runs with interrupts disabled, so the next ADC interrupt
+//					waits until the loop is back in IDLE.  SCHED_URGENT tasks run
+//					whenever they are due and ready.  The others run only if their
+//					expected time still fits before the next ADC interrupt (the
+//					deadline, SCHED_SLOT_CYCLES after ulAdcIntStamp, less SCHED_MARGIN).
+//					A task that does not fit waits for a sample with more slack, but
+//					never more than SCHED_MAX_WAIT samples, so a task that is longer
+//					than a whole sample still gets its turn.
+//
+//					The expected time is a peak of the measured run times that decays
+//					by 1/16 per run, so one long command does not hold a task back for
+//					good.  The run times are measured with the free-running cycle
+//					counter (CYCLE_COUNT()) and added to the CPU load meter (load.c).
+//
+// Copyright (C) 2005 Texas Instruments Incorporated
+// Texas Instruments Proprietary Information
+// Use subject to terms and conditions of TI Software License Agreement
+//
+// Revision History:
+// 19Oct26			New file.
+// 19Oct26			Run times from the free-running cycle counter, added to the load meter.
+//==========================================================================================
+
+#include "main.h"
+#include <string.h>						// contains memset()
+
+#define	RAMFUNCS_SCHED						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
+
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+#define	SCHED_MAX_WAIT		64			// samples a due, ready task waits for slack at most
+
+
+//==========================================================================================
+// Global variables declared in main.h
+//==========================================================================================
+schedTask		schedTable[SCHED_MAX_TASKS];	// Tasks, highest priority first
+u16				uSchedTasks = 0;				// Entries used in schedTable[]
+volatile u32	ulAdcIntStamp = 0;				// CYCLE_COUNT() at the last ADC interrupt
+
+
+//==========================================================================================
+// Function:		SchedCycles()
+//
+// Description: 	CPU cycles from ulStart (CYCLE_COUNT()) to now, at most 0xFFFF.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Free-running cycle counter instead of CpuTimer0.
+//==========================================================================================
+u16 SchedCycles(u32 ulStart)
+{
+	return ((u16)Min(CYCLE_COUNT() - ulStart, 0xFFFF));
+}
+
+
+//==========================================================================================
+// Function:		SchedInit()
+//
+// Description: 	Empty the task table.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+void SchedInit(void)
+{
+	memset(schedTable, 0, sizeof(schedTable));
+	uSchedTasks = 0;
+}
+
+
+//==========================================================================================
+// Function:		SchedAdd()
+//
+// Description: 	Add a task behind the tasks of the same or higher priority.
+//					pfReady may be 0 for a task that is always ready.  The task is due
+//					at the first sample.  Returns its index in schedTable[], SCHED_FULL
+//					if the table is full.
+//
+// Revision History:
+// 19Oct26			New function.
+//==========================================================================================
+u16 SchedAdd(void (*pfRun)(void), u16 (*pfReady)(void), u16 uPeriod, u16 uPriority)
+{
+	u16		i;
+
+	if (uSchedTasks >= SCHED_MAX_TASKS)
+		return (SCHED_FULL);
+
+	for (i=uSchedTasks; (i > 0) && (schedTable[i-1].uPriority > uPriority); i--)
+		schedTable[i] = schedTable[i-1];
+	uSchedTasks++;
+
+	memset(&schedTable[i], 0, sizeof(schedTask));
+	schedTable[i].pfRun = pfRun;
+	schedTable[i].pfReady = pfReady;
+	schedTable[i].uPeriod = Max(uPeriod, 1);
+	schedTable[i].uPriority = uPriority;
+
+	return (i);
+}
+
+
+//==========================================================================================
+// Function:		SchedRun()
+//
+// Description: 	One pass of the scheduler, called by MainLoop() once per receive
+//					sample.  Runs the tasks that are due, ready and fit before the
+//					deadline, and measures their run times.
+//
+// Revision History:
+// 19Oct26			New function.
+// 19Oct26			Run times added to the load meter.
+//==========================================================================================
+void SchedRun(void)
+{
+	schedTask	*pTask;
+	u32			ulStart;
+	u32			ulCycles;
+	u16			uUsed;
+	u16			i;
+
+	for (i=0; i<uSchedTasks; i++)
+	{
+		pTask = &schedTable[i];
+
+		if (pTask->uDue > 0)
+			pTask->uDue--;
+		if (pTask->uDue > 0)
+			continue;								// not due yet
+
+		if ((pTask->pfReady != 0) && (pTask->pfReady() == False))
+			continue;								// due, but nothing to do
+
+		if ((pTask->uPriority != SCHED_URGENT) && (pTask->uWait < SCHED_MAX_WAIT))
+		{
+			uUsed = SchedCycles(ulAdcIntStamp);
+			if ((u32)uUsed + pTask->uEstCycles + SCHED_MARGIN > SCHED_SLOT_CYCLES)
+			{
+				pTask->uWait++;						// wait for a sample with more slack
+				pTask->ulDeferred++;
+				continue;
+			}
+		}
+
+		ulStart = CYCLE_COUNT();
+		pTask->pfRun();
+		ulCycles = CYCLE_COUNT() - ulStart;
+		ulLoadCycles[LOAD_TASK + i] += ulCycles;
+		pTask->uLastCycles = (u16)Min(ulCycles, 0xFFFF);
+
+		if (pTask->uLastCycles > pTask->uMaxCycles)
+			pTask->uMaxCycles = pTask->uLastCycles;
+		pTask->uEstCycles = Max(pTask->uLastCycles, pTask->uEstCycles - (pTask->uEstCycles >> 4));
+		pTask->ulRuns++;
+		pTask->uWait = 0;
+		pTask->uDue = pTask->uPeriod;
+	}
+}
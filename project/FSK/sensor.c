@@ -11,19 +11,15 @@
 // 05/20/02	HEM		Started file for CAN project from Jervis project.
 // 11/17/04	HEM		Removed unused function ReadSmoothedSensor().
 // 					Removed unused variables left over from CAN project.
+// 19Oct26			OVERSAMPLE_RATE and the combining mode moved to adcfront.h.
+// 19Oct26			Mains sense conversion at the end of the receive sequence (ZC_SYNC).
+// 19Oct26			ADC power up split into ConfigureADCs() and PowerUpADCs().
 //==========================================================================================
 
 #include "main.h"
 
-// Functions that will be run from RAM need to be assigned to 
-// a different section.  This section will then be mapped using
-// the linker cmd file.
-#ifdef __cplusplus			// "C++"
-#pragma CODE_SECTION("ramfuncs"); 
-#else						// "C"
-#pragma CODE_SECTION(ArmAllSensors, "ramfuncs");
-#pragma CODE_SECTION(SmoothSensor, "ramfuncs");
-#endif
+#define	RAMFUNCS_SENSOR						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
 
 //==========================================================================================
 // Local function prototypes
@@ -37,26 +33,34 @@ extern u16	uADCTimeoutCnt;	// Count of timeouts while waiting for ADC sequencer
 
 
 //==========================================================================================
-// Local constants
+// Local variables
 //==========================================================================================
-//	#define	OVERSAMPLE_RATE	16
-//	#define	REMOVE_HILO		(~True)
+static u32	ulAdcRefStamp = 0;		// CYCLE_COUNT() when the reference was powered up
 
-//	#define	OVERSAMPLE_RATE	1
-//	#define	REMOVE_HILO		(~True)
-	
-//	#define	OVERSAMPLE_RATE	2
-//	#define	REMOVE_HILO		(~True)
- 	
-// IMPORTANT!  This value must match value assigned in subs.asm
-//	#define	OVERSAMPLE_RATE	10
-	#define	OVERSAMPLE_RATE			4
-	    asm("OVERSAMPLE_RATE .set	4");
+
+//==========================================================================================
+// Local constants
+//==========================================================================================
+// OVERSAMPLE_RATE and ADC_FRONT_MODE are set in adcfront.h, shared with subs.asm
+#if (ADC_FRONT_MODE == ADC_FRONT_TRIM)
 	#define	REMOVE_HILO		True
-//	#define	REMOVE_HILO		(~True)
+#else
+	#define	REMOVE_HILO		(~True)
+#endif
+
+// The receive sequence is OVERSAMPLE_RATE conversions of ADC_RX_CHANNEL, followed by
+// one conversion of the mains sense input when ZC_SYNC is on.
+#if (ZC_SYNC == True)
+	#define	ADC_CONV_TOTAL	(OVERSAMPLE_RATE+1)
+#else
+	#define	ADC_CONV_TOTAL	(OVERSAMPLE_RATE)
+#endif
+#if (ADC_CONV_TOTAL > 16)
+	#error "ADC sequence too long for the mains sense conversion"
+#endif
 
-//	#define	OVERSAMPLE_RATE	3
-//	#define	REMOVE_HILO		True
+#define	ADC_CHSEL(n)		((u16)(((n) < OVERSAMPLE_RATE) ? ADC_RX_CHANNEL : ZC_ADC_CHANNEL))
+#define	ADC_CHSELSEQ(w)		(ADC_CHSEL(4*(w)) | (ADC_CHSEL(4*(w)+1)<<4) | (ADC_CHSEL(4*(w)+2)<<8) | (ADC_CHSEL(4*(w)+3)<<12))
 
 
 // These clock constant must also be defined in assembly because they are used in the RPTNOP() assembly macro.
@@ -65,6 +69,9 @@ extern u16	uADCTimeoutCnt;	// Count of timeouts while waiting for ADC sequencer
    asm("HSPCPS	.set 1"); 
 						//!!! Move this to main.h and use it in InitSysCtrl().
 
+// Reference and bandgap settling time before the rest of the ADC is powered up
+#define	ADC_REF_SETTLE		((u32)(DSP_FREQ / 200))	// 5 ms in CPU cycles
+
 // ADC Clock PreScale.  Ratio of HiSpeed Peripheral Clock / ADC Core Clock
 // Allowed values: Min = 1, Max = 30.  Odd values other than 1 will round down.
 // Additional requirement: Do not exceed 25 MHz.
@@ -90,6 +97,8 @@ extern u16	uADCTimeoutCnt;	// Count of timeouts while waiting for ADC sequencer
 // 06/12/02 HEM		Added analog circuit power-ups.
 // 06/20/02 HEM		Changed ADC control delays to match clock settings.
 //					Configured each bit field in ADCTRL3 individually.
+// 19Oct26			Cascaded sequencers for more than 8 conversions.
+// 19Oct26			Returns once the reference is powering up, PowerUpADCs() does the rest.
 //==========================================================================================
 void	ConfigureADCs(void)
 {
@@ -97,8 +106,11 @@ void	ConfigureADCs(void)
 	#define	ACQ_PS			2		// Acquisition prescaler = 2x longer
 //	#define	ACQ_PS			1		// Acquisition prescaler = fastest possible
 
-//	#define	ADCTRL1_INIT	(0x3010|((ACQ_PS-1)<<8))	// Soft&free=1, Cascaded sequencers
+#if (ADC_CONV_TOTAL > 8)						// SEQ1 alone only does 8 conversions
+	#define	ADCTRL1_INIT	(0x3010|((ACQ_PS-1)<<8))	// Soft&free=1, Cascaded sequencers
+#else
 	#define	ADCTRL1_INIT	(0x3000|((ACQ_PS-1)<<8))	// Soft&free=1, Separate sequencers	
+#endif
 	#define	ADCTRL1_RESET	0x4000	// Reset sequencers
 	
 
@@ -117,7 +129,25 @@ void	ConfigureADCs(void)
 //?	RPTNOP(ADC_CTRL_DELAY);					// Wait for control change to take effect (needed?)
 
 	AdcRegs.ADCTRL3.bit.ADCBGRFDN = 0x3;	// Power up Vref and Bandgap
-	DelayNus(5000);							// Wait 5 ms 
+	ulAdcRefStamp = CYCLE_COUNT();			// PowerUpADCs() waits out the 5 ms from here
+}
+
+
+//==========================================================================================
+// Function:		PowerUpADCs()
+//
+// Description: 	Wait until the reference powered up by ConfigureADCs() has had its
+//					5 ms, then power up the rest of the ADC and set the sequence.  main()
+//					does other initialization in between instead of waiting at once.
+//					The cycle counter (LoadInit()) must be running.
+//
+// Revision History:
+// 19Oct26			New function, from the end of ConfigureADCs().
+//==========================================================================================
+void	PowerUpADCs(void)
+{
+	while (CYCLE_COUNT() - ulAdcRefStamp < ADC_REF_SETTLE)
+		;									// Rest of the 5 ms
 
 	AdcRegs.ADCTRL3.bit.ADCPWDN = 0x1;		// Power up rest of ADC circuits
 	DelayNus(20);							// Wait 20 us
@@ -149,6 +179,8 @@ void	ConfigureADCs(void)
 //
 // Revision History:
 // 05/13/04	HEM		New function.
+// 19Oct26			Conversion time next to MAX_ADC_WAIT.
+// 19Oct26			MAX_ADC_WAIT counts the whole sequence (ADC_CONV_TOTAL).
 
 //==========================================================================================
 void ReadAllSensors(u16 uWaitFlag)
@@ -170,7 +202,10 @@ void ReadAllSensors(u16 uWaitFlag)
 	// Wait	this many microseconds for the ADC sequence to complete before reporting ADC Timeout.  
 	// This formula is not very precise, but it does include the effect of the peripheral
 	// clock and ADC clock dividers as well as the number of samples being collected.
-	#define MAX_ADC_WAIT	(((OVERSAMPLE_RATE*HSPCPS*ADCPS)/5)+1)	
+	// It counts every conversion of the sequence (ADC_CONV_TOTAL, with the mains sense
+	// one).  A conversion takes ACQ_PS+1 ADC clocks of HSPCPS*ADCPS CPU cycles, 0.18 us
+	// at 100 MHz, so 1.2 us per conversion is a wide margin up to 16 conversions.
+	#define MAX_ADC_WAIT	(((ADC_CONV_TOTAL*HSPCPS*ADCPS)/5)+1)	
 
 
 	//SetXF();					// Turn on XF flag for debug aid
@@ -265,18 +300,18 @@ void ArmAllSensors(void)
 // 	AdcRegs.ADCCHSELSEQ2.all = 0x7654;
 //	AdcRegs.ADCCHSELSEQ1.all = 0x3210;
 
-	AdcRegs.ADCCHSELSEQ1.all = 0x6666;
-#if	OVERSAMPLE_RATE > 4	
-	AdcRegs.ADCCHSELSEQ2.all = 0x6666;
-	#if	OVERSAMPLE_RATE > 8	
-		AdcRegs.ADCCHSELSEQ3.all = 0x6666;
-		#if OVERSAMPLE_RATE >12
-			AdcRegs.ADCCHSELSEQ4.all = 0x6666;
+	AdcRegs.ADCCHSELSEQ1.all = ADC_CHSELSEQ(0);
+#if	ADC_CONV_TOTAL > 4	
+	AdcRegs.ADCCHSELSEQ2.all = ADC_CHSELSEQ(1);
+	#if	ADC_CONV_TOTAL > 8	
+		AdcRegs.ADCCHSELSEQ3.all = ADC_CHSELSEQ(2);
+		#if ADC_CONV_TOTAL >12
+			AdcRegs.ADCCHSELSEQ4.all = ADC_CHSELSEQ(3);
 		#endif
 	#endif
 #endif
 			
-	AdcRegs.ADCMAXCONV.all = OVERSAMPLE_RATE-1;   //!!!DEBUG!!! Set number of samples to collect
+	AdcRegs.ADCMAXCONV.all = ADC_CONV_TOTAL-1;   // Set number of samples to collect
 
 	AdcRegs.ADCTRL2.all |= ADCTRL2_RESET_SEQ;		//aaa Reset the sequencers
 //??? NEEDED?	RPTNOP(ADC_CTRL_DELAY);						// Wait for control change to take effect
@@ -3,6 +3,7 @@
 ;
 ; Description:	Assembly function subroutines used to perform low level routines that
 ;				aren't possible from C.
+;				kernels.c has C versions of each one (KERNEL_IMPL in main.h).
 ;
 ; Copyright (C) 2002 Texas Instruments Incorporated
 ; Texas Instruments Proprietary Information
@@ -10,6 +11,9 @@
 ;
 ; Revision History:
 ; 06/24/02	EGO		Started file.  From jervis project.
+; 19Oct26			Pointed to the C versions in kernels.c.
+; 19Oct26			Sat16 of 0x80000000 fixed.  Saturate removed, Saturate() is a macro.
+; 19Oct26			SmoothADCResults section chosen by ramfuncs.h.
 ;===========================================================================================
 
 ;===========================================================================================
@@ -71,42 +75,22 @@ _WriteProg:
 ;
 ; Revision History:
 ; 07/18/02  HEM		New function.
+; 19Oct26			Overflow mode around the first NEG: 0x80000000 negated is itself and
+;					came back as 0, now -32767 like the C versions.
 ;===========================================================================================
  .def _Sat16
 
 _Sat16:								; First argument already in ACC
 	MOVL 	XAR4, #0x7FFF			; Set XAR4 = Upper limit = +32767
 	MINL 	ACC, @XAR4 				; Set ACC = MIN(ACC, +32767)
+	SETC	OVM						; Saturate the NEG: -0x80000000 = 0x7FFFFFFF
 	NEG 	ACC						; Negate ACC
+	CLRC	OVM						; Compiler runs with OVM clear
 	MINL 	ACC, @XAR4 				; Set ACC = MIN(-ACC, +32767) == MAX(ACC,-32767)
 	NEG		ACC						; Negate ACC back to its proper sign
 	LRETR							; Return with saturated value in ACC
 
 
-;===========================================================================================
-; Function:		Saturate
-;
-; Description: 	This function saturates a value to a specified range.
-;
-; Input:		ACC   = Arg1 = Value
-;				SP[4] = Arg2 = Lower Limit
-;				SP[2] = Arg3 = Upper Limit
-;
-; Output:		ACC 
-;
-; Revision History:
-; 07/18/02  HEM		New function
-;===========================================================================================
- .def _Saturate
-
-_Saturate:							; First argument already in ACC
-	MINL	ACC, *-SP[2]			; Set ACC = MIN(ACC, upper limit)
-	MAXL	ACC, *-SP[4]			; Set ACC = MAX(ACC, lower limit)
-	LRETR							; Return with saturated value in ACC
-
-;??? Might have the two arguments swapped???
-
-
 ;;===========================================================================================
 ;; Function:		Max16
 ;;
@@ -147,14 +131,19 @@ _Saturate:							; First argument already in ACC
 
 
  .def	_SmoothADCResults
+ .ref	_AdcFrontEnd
 AdcRegs_ADCRESULT0	.set	7108H
-; OVERSAMPLE_RATE		.set	6
-OVERSAMPLE_RATE		.set	4	;IMPORTANT!  This value must match value assigned in sensor.c
+	.cdecls C, NOLIST, "adcfront.h"		; OVERSAMPLE_RATE and ADC_FRONT_* shared with the C code
+	.cdecls C, NOLIST, "ramfuncs.h"		; RAMFUNCS_ASM_SmoothADCResults, set by ProfPlace() (prof.c)
 ;===========================================================================================
 ; Function:		SmoothADCResults
 ;
-; Description: 	This function calculates the average of the ADC readings, after discarding
-;				the highest and lowest readings.
+; Description: 	This function combines the OVERSAMPLE_RATE ADC readings of one receive
+;				sample into a signed value, as selected by ADC_FRONT_MODE in adcfront.h:
+;				ADC_FRONT_TRIM		average after discarding the highest and lowest readings
+;				ADC_FRONT_MEAN		average of all readings
+;				ADC_FRONT_MEDIAN	branch to the C version AdcFrontEnd() in adcfront.c
+;				The division is a multiply by a Q12 reciprocal, bit exact with AdcFrontEnd().
 ;
 ; Prototype:	u16 SmoothADCResults (void)
 ;
@@ -164,9 +153,22 @@ OVERSAMPLE_RATE		.set	4	;IMPORTANT!  This value must match value assigned in sen
 ;
 ; Revision History:
 ; 10/19/04  HEM		New function
+; 19Oct26			OVERSAMPLE_RATE 3..16 from adcfront.h, mean and median modes,
+;					reciprocal multiply instead of a fixed shift
+; 19Oct26			Runs from RAM when ramfuncs.h places it there.
 ;===========================================================================================
+	.if	RAMFUNCS_ASM_SmoothADCResults
+	.sect	"ramfuncs"
+	.else
+	.text
+	.endif
 _SmoothADCResults:
 
+	.if	ADC_FRONT_MODE == ADC_FRONT_MEDIAN
+	MOVL	XAR4, #AdcRegs_ADCRESULT0	; First argument: pointer to raw ADC results
+	LB		_AdcFrontEnd				; C version returns directly to our caller
+	.else
+
 	ADDB	SP,  #OVERSAMPLE_RATE		; Reserve space on stack for ADC results
 	SETC	SXM							; Turn on sign-extension mode (signed numbers)
 
@@ -181,6 +183,7 @@ SAR_Loop:
 		MOV		*--XAR5, ACC 			; Store on stack
 	BANZ	SAR_Loop, AR4--				; Bottom of loop		
 
+	.if	ADC_FRONT_MODE == ADC_FRONT_TRIM
 	; --- Find largest value in ADC Results array ---
 	MOV		AH, #-8000H					; Start AH at large negative value
 	MOVZ	AR5, @SP					; XAR5 = Pointer into signed ADC results array on stack
@@ -194,6 +197,7 @@ SAR_Loop:
 	RPT		#(OVERSAMPLE_RATE-1)		;
 ||	MIN		AL, *--XAR5 				; AL = Smallest sample in ADC results array
 	MOV		PL, @AL						; Store smallest sample in PL
+	.endif
 
 	; --- Calculate sum of ADC Results array ---
 	MOV		ACC, #0
@@ -201,22 +205,20 @@ SAR_Loop:
 	RPT		#(OVERSAMPLE_RATE-1)
 ||	ADD 	ACC, *--XAR5				; ACC = Running Sum
 
+	.if	ADC_FRONT_MODE == ADC_FRONT_TRIM
 	SUB		ACC, @PH					; Subtract largest sample
 	SUB		ACC, @PL					; Subtract smallest sample
-
-	; --- Divide by (OVERSAMPLE_RATE-2)	---
-	.if	OVERSAMPLE_RATE == 3
-	  									; Divide by (3-2)
-	.elseif OVERSAMPLE_RATE == 4	
-	SFR		ACC, 1						; Divide by (4-2)
-	.elseif OVERSAMPLE_RATE == 6
-	SFR		ACC, 2						; Divide by (6-2)
-	.else
-	.emsg "Invalid value for OVERSAMPLE_RATE"	
 	.endif
+
+	; --- Divide by ADC_FRONT_DIV: multiply with Q12 reciprocal, then shift ---
+	MOVL	XT, @ACC					; XT = sum
+	MOVL	XAR4, #ADC_FRONT_RECIP		; XAR4 = 4096/ADC_FRONT_DIV
+	IMPYL	ACC, XT, @XAR4				; ACC = sum * reciprocal (fits in 32 bits)
+	SFR		ACC, ADC_FRONT_RECIP_SCALE	; Remove Q12 scaling (arithmetic, SXM is set)
 	
 	SUBB	SP,  #OVERSAMPLE_RATE		; Restore stack pointer
 	LRETR
+	.endif
 
 
 
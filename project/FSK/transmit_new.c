@@ -23,20 +23,8 @@ void ExtractNextTxBit(void);
 void ExtractNextRxBit(void);
 
 
-// Functions that will be run from RAM need to be assigned to 
-// a different section.  This section will then be mapped using
-// the linker cmd file.
-#ifdef __cplusplus			// "C++"
-	#pragma CODE_SECTION("ramfuncs"); 
-#else						// "C"
-	//#pragma CODE_SECTION(HammingDistance, "ramfuncs");
-	//#pragma CODE_SECTION(SetRxMode, "ramfuncs");
-
-	//#pragma CODE_SECTION(T1PINT_ISR, "ramfuncs");
-	#pragma CODE_SECTION(adc_isr, "ramfuncs");
-
-	//#pragma CODE_SECTION(FilterCorrRx, "ramfuncs");
-#endif
+#define	RAMFUNCS_TRANSMIT_NEW						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
 
 
 
@@ -54,12 +42,13 @@ q16	qPolarity= 0;		// Polarity of most recently received bit
 
 //s16		demodBuf[ADCINT_COUNT_MAX]; //arefeen
 s16		adctest[ADCINT_COUNT_MAX]; //arefeen
-s16		ADCsample[ADCINT_COUNT_MAX];
 //s16		demod	= 0; // arefeen
 s16		test1 = 0;
 s16	    test2 = 0;
 u16		DEMOD_SCALE = 15;
 
+u16		uFloodSeed = 0;					// seed of the last flood frame, to repeat it on a retry
+
 //==========================================================================================
 // Function:		GenerateFakePLCMessage()
 //
@@ -114,10 +103,19 @@ u16 GenerateFakePLCMessage(u16	uSeed)
 // Revision History:
 // 09/02/04	HEM		New function
 // 11/17/04	HEM		Reduce longest fake message from 32 to 16 bytes.
+// 19Oct26			Frame length and retries from the link table (LINK_ADAPT).
 //==========================================================================================
 u16 GenerateFloodPLCMessage(u16	uSeed)
 {
 	u16	i = 0;
+	u16	uMsgLen = MAX_TX_MSG_LEN;
+
+	#if LINK_ADAPT == True
+	if( LinkTimeout() )
+		uSeed = uFloodSeed;			// last frame was not acked: send it again
+	uFloodSeed = uSeed;
+	uMsgLen = LinkFrameLen(uDestAddress);
+	#endif
 
 	//---- Set up Echo command -----
 	txUserDataArray[i++] = uDestAddress>>8;			// slave address
@@ -129,7 +127,7 @@ u16 GenerateFloodPLCMessage(u16	uSeed)
 	txUserDataArray[i++] = SUCCESS;				// return code
 	
 	uSeed &= 0x00FF;
-	for (; i<MAX_TX_MSG_LEN; i++)
+	for (; i<uMsgLen; i++)
 	{	
 		txUserDataArray[i]= uSeed++ & 0xFF;	//Fill buffer with some non-zero data
 	}
@@ -138,8 +136,11 @@ u16 GenerateFloodPLCMessage(u16	uSeed)
 	uCommandActive = 0;		// Command is done.  Allow TaskCommand to finish up.
 	ulBerStats[BER_TX_COUNT]++;				// Add more here!!!
 	uCmd_EchoAck = False;	// toggle the var while sending BER packet
+	#if LINK_ADAPT == True
+	LinkTxSent(uDestAddress);
+	#endif
 
-	return(MAX_TX_MSG_LEN);
+	return(uMsgLen);
 }
 
 
@@ -288,6 +289,7 @@ const u16	uTrailer [(TRAILER_LEN+15)/16] = {0xE67C, 0xCC00};
 //
 // Revision History:
 // 05/04/04	HEM		New Function.
+// 19Oct26			Append FEC parity after the CRC.
 //==========================================================================================
 void FillTxBuffer(u16 uUserTxMsgLen)
 {
@@ -300,6 +302,11 @@ void FillTxBuffer(u16 uUserTxMsgLen)
 	u16	uCRC;
 	u16 uCRCByte;
 #endif
+#if FEC_ENABLE == True
+	u16	upFecMsg[MAX_TX_MSG_LEN+2];		// data and CRC bytes
+	u16	upFecParity[FEC_PARITY_LEN];
+	u16	uFecLen;
+#endif
 
 	// Copy the header into the transmit data array
 	for (i=0; i<((HEADER_LEN+15)/16); i++)
@@ -342,6 +349,33 @@ void FillTxBuffer(u16 uUserTxMsgLen)
 		}
 	#endif
 
+	// Calculate the FEC parity over the data and CRC and copy it into the transmit data array
+	#if FEC_ENABLE == True
+		for (i=0; i<uUserTxMsgLen; i++)
+		{
+			upFecMsg[i] = txUserDataArray[i];
+		}
+		uFecLen = uUserTxMsgLen;
+		#if	USE_CRC  == True
+			upFecMsg[uFecLen++] = uCRC >> 8;
+			upFecMsg[uFecLen++] = uCRC & 0x00FF;
+		#endif
+		FecEncode(upFecMsg, uFecLen, upFecParity);
+
+		for (i=0; i<FEC_PARITY_LEN; i++)
+		{
+			uWord = uBitNum / 16;
+			j = (uBitNum & 15);
+
+			txDataArray[uWord] |= uTxPrecodeTable[upFecParity[i]] >> j;		// Top of precoded data word into outgoing data word
+			if (j >= (16-11))
+			{
+				txDataArray[++uWord]  = uTxPrecodeTable[upFecParity[i]] << (16-j);	// Bottom of precoded data word into top of next outgoing data word
+			}
+			uBitNum += 11;
+		}
+	#endif
+
 
 	// Copy the trailer into the transmit data array
 	uWord = uBitNum / 16;
@@ -466,12 +500,22 @@ interrupt void T1PINT_ISR(void)    // EV-A
 //
 // Revision History:
 // 04/15/04	HEM		New Function.
+// 19Oct26			Impulse blanker between SmoothADCResults() and the demodulator.
+// 19Oct26			Mains zero-crossing tracking from the last conversion of the sequence.
+// 19Oct26			Noise scanner fed with the raw samples while idle.
+// 19Oct26			Impulse blanker and demod moved to RxDemod() so the host build runs the
+//					same code (golden vectors).
+// 19Oct26			Time stamp for the scheduler deadline.
+// 19Oct26			Own run time added to the load meter.
 //==========================================================================================
 interrupt void  adc_isr(void)     // ADC
 {
-//	static s16		ADCsample[ADCINT_COUNT_MAX];
 	static u16		test3;
+	s16				sSample;				// receive sample from the ADC burst
+	u32				ulCycles;				// run time, for the load meter
 	
+	ulAdcIntStamp = CYCLE_COUNT();			// start of this sample slot (sched.c)
+
 	//u16				n;
 //	test1++;
 //	test2 = 0;
@@ -536,55 +580,33 @@ interrupt void  adc_isr(void)     // ADC
 	//========= RECEIVE =====================================	
 	if ((plcMode == RX_MODE) || (RECEIVE_OWN_XMIT == True))
 	{
-		//---- set receive sample buffer index and delayed index ----------
-		ADCIntCount++;
-		if( ADCIntCount >= ADCINT_COUNT_MAX )
-			ADCIntCount = 0;
-		ADCIntCountDelay = ADCIntCount - QUARTER_PER_DELAY;
-		if( ADCIntCountDelay > (ADCINT_COUNT_MAX - QUARTER_PER_DELAY ))
-			ADCIntCountDelay += ADCINT_COUNT_MAX;
-
 		//---- Get the latest ADC sample -------------------
-		ADCsample[ADCIntCount] = SmoothADCResults();	// Combine the results from A/D Converter, 
-														// scale them, and convert them to signed values	
+		sSample = SmoothADCResults();	// Combine the results from A/D Converter, 
+										// scale them, and convert them to signed values	
 														
-//		ADCsample[ADCIntCount] =  AdcRegs.ADCRESULT0-0x8000; 			// TEMP!!! Grab single value without smoothing
+//		sSample =  AdcRegs.ADCRESULT0-0x8000; 			// TEMP!!! Grab single value without smoothing
+
+		#if ZC_SYNC == True
+		ZcDetect( (s16)((&AdcRegs.ADCRESULT0)[OVERSAMPLE_RATE] - 0x8000) );	// mains sense is the last conversion
+		#endif
 														
 		ArmAllSensors();				// Re-arm the sensors for the next reading
 		
-		//---- do demod multiplication & lowpass filter ---------------------
-		
-		
-		demod -= demodBuf[ADCIntCount];
-		//test1 = (s16)( ( (s32)ADCsample[ADCIntCount] * (s32)ADCsample[ADCIntCountDelay] ) >> DEMOD_SCALE );
-		test1 = (s16)( ( (s32)ADCsample[ADCIntCount] * (s32)ADCsample[ADCIntCountDelay] ) >> 16 );
-		test1 = test1 >> 3;
-//		test1 = test1 >> 4;  //08
-
-		//test2 = (s16)( ( (s32)ADCsample[ADCIntCount] * (s32)ADCsample[ADCIntCount] ) >> DEMOD_SCALE );
-		//test2 = test2 >> (3+4);
-		
-		demodBuf[ADCIntCount] = test1 + test2;
-//		demodBuf[ADCIntCount] = test1;
-		
-		
-		//demodBuf[ADCIntCount] = test1 >> 2;
-//		demodBuf[ADCIntCount] = (s16)( ( (s32)ADCsample[ADCIntCount] * (s32)ADCsample[ADCIntCountDelay] ) >> DEMOD_SCALE );
-		demod += demodBuf[ADCIntCount];
-			
-//		SaveTrace(ADCsample[ADCIntCount]);	//save receive signal values to diag buffer
-//		SaveTrace(demod);		 			// 2nd trace var
-		
-//		if (demod >= test1)
-//		{ test1 = demod;}
-//		
-//		if (demod <= test2)
-//		{test2 = demod;}
-//
-		receive(demod);						// call bit detection function
+		#if NOISE_SCAN == True
+		if( uScanActive )
+			ScanSample( sSample );		// ahead of the blanker, so impulses are seen
+		#endif
+
+		receive( RxDemod(sSample) );	// impulse blanker and demod (adcfront.c), then bit detection
 	}
 	test3++;
 	uADCIntFlag = 1;						// Set flag to tell MainLoop() that ADC Interrupt occurred
+
+	ulCycles = CYCLE_COUNT() - ulAdcIntStamp;
+	ulLoadCycles[LOAD_ISR] += ulCycles;
+	if (ulCycles > uLoadIsrMax)
+		uLoadIsrMax = (u16)Min(ulCycles, 0xFFFF);
+
 	PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;	// Enable PIE interrupts	
 	EINT;   								// Re-Enable Global interrupt INTM
 	return;
@@ -19,6 +19,8 @@
 //==========================================================================================
 
 #include "main.h"
+#define	RAMFUNCS_UART						// this file's block of ramfuncs.h
+#include "ramfuncs.h"					// functions run from RAM
 
 
 //==========================================================================================
@@ -321,10 +323,11 @@ Description: 	This function is used to send/receive data to the UART.
  10/15/02 HEM		Changed from Timer2 to Timer0.  Changed reg name to match data sheet.
  02/17/05 Hagen		Rewrote the routine so that we only do one receive byte or two transmit 
  					bytes at a time.  
+ 19Oct26			Called every receive sample by the scheduler, timeout counted in samples.
 ==========================================================================================*/
 #define RTS_ENABLE  	(0)
 #define RTS_DISABLE 	(1)
-#define RECEIVE_TIMEOUT	(11500)			// 1/2 second w/o character = flush.
+#define RECEIVE_TIMEOUT	((u16)(RX_Sampling/2))	// 1/2 second w/o character = flush.
 #define	ALMOST_FULL		12				// Choose hold-off level for buffer.  Must be <= 15
 
 void HandleUART(void)
@@ -44,6 +44,7 @@ u16	upSerialCommand[COMMAND_PARMS];
 
 u16	uCommandPending;
 u16	uCommandActive;
+u16	uCommandMulticast = False;
 //u16	uCalibActive;
 //u16 uSampleRate;
 
@@ -80,6 +81,9 @@ u8	ubPhysicalMinLevel;				// const
 // Variables declared in plc.h
 u16		plcMode = RX_MODE;		// Power Line Communications mode.  TX or RX
 u16		plcModeSnap = RX_MODE;	// Power Line Communications mode.  TX or RX
+u16		uSoftBit = 0;			// Magnitude of the last bit decision integral (soft bit)
+s16		sRxDemodBias = 0;		// Demod DC bias latched at the last preamble
+s16		sRxFreqOffset = 0;		// Carrier offset (Hz) estimated at the last preamble
 u16		uRxMode = FIND_BITSYNC;	// PLC Receive Mode
 u16		T1PIntCount;			// EV Timer1 Period Interrupt counts
 //u16	T2PIntCount;			// EV Timer2 Period Interrupt counts
@@ -99,10 +103,13 @@ u16 	uRxModeCount=0;		// number of ADC INT counts we have been in a given rxMode
 u16		rxUserDataArray[MAX_RX_MSG_LEN];	// byte-wide buffer for user data
 u16		txUserDataArray[MAX_TX_MSG_LEN]; 	// byte-wide buffer for user data
 u16		txDataArray[TX_ARRAY_LEN]; 			// word-wide byte-packed buffer for user transmit data, including headers, trailers, parity, and start/stop bits
-u16 	rxDataArray[RX_ARRAY_LEN];			// word-wide byte-packed buffer for user receive data, including headers, trailers, parity, and start/stop bits
 
 u32		ulPlcStats[PLC_STATS_LEN/2/2][2];	// Statistics for PLC communication
 u32		ulBerStats[BER_STATS_LEN/2];		// Statistics for BER testing
+u32		ulZcNoise[ZC_PHASE_BINS];			// Blanked samples per mains phase bin
+u32		ulZcStats[ZC_PHASE_BINS][2];		// Receive results per mains phase bin
+rxQualityType	rxQuality;					// Link quality of the last packet (latched at EOP)
+u32		ulRxQualHist[4][QUAL_HIST_BINS];	// Link quality histograms
 
 
 // Variables declared in diag.h
@@ -139,6 +146,88 @@ s16		demodBuf[ADCINT_COUNT_MAX]; 	// receive FIR buffer
 s16		demod;							// accumulator for receiver FIR
 
 
+//---- constant tables (.econst, flash in the release build) -------------
+	// Transmitter pre-code table.  
+	// Pre-codes data so that differential detector spits out data directly.
+	// Also appends parity bit and two start/stop bits. 
+	// Input = 8 bits of user data.  Output = Top 11 bits.
+//#define TXDIFF
+#ifdef TXDIFF	
+	const u16	uTxPrecodeTable[256] = 
+	{
+		0x5520, 0x54A0,	0x5620,	0x57A0,	0x52A0,	0x5320,	0x51A0,	0x5020,	
+		0x5A20,	0x5BA0,	0x5920,	0x58A0,	0x5DA0,	0x5C20,	0x5EA0,	0x5F20,	
+		0x4AA0,	0x4B20,	0x49A0,	0x4820,	0x4D20,	0x4CA0,	0x4E20,	0x4FA0,	
+		0x45A0,	0x4420,	0x46A0,	0x4720,	0x4220,	0x43A0,	0x4120,	0x40A0,	
+		0x6A20,	0x6BA0,	0x6920,	0x68A0,	0x6DA0,	0x6C20,	0x6EA0,	0x6F20,	
+		0x6520,	0x64A0,	0x6620,	0x67A0,	0x62A0,	0x6320,	0x61A0,	0x6020,	
+		0x75A0,	0x7420,	0x76A0,	0x7720,	0x7220,	0x73A0,	0x7120,	0x70A0,	
+		0x7AA0,	0x7B20,	0x79A0,	0x7820,	0x7D20,	0x7CA0,	0x7E20,	0x7FA0,	
+		0x2AA0,	0x2B20,	0x29A0,	0x2820,	0x2D20,	0x2CA0,	0x2E20,	0x2FA0,	
+		0x25A0,	0x2420,	0x26A0,	0x2720,	0x2220,	0x23A0,	0x2120,	0x20A0,	
+		0x3520,	0x34A0,	0x3620,	0x37A0,	0x32A0,	0x3320,	0x31A0,	0x3020,	
+		0x3A20,	0x3BA0,	0x3920,	0x38A0,	0x3DA0,	0x3C20,	0x3EA0,	0x3F20,	
+		0x15A0,	0x1420,	0x16A0,	0x1720,	0x1220,	0x13A0,	0x1120,	0x10A0,	
+		0x1AA0,	0x1B20,	0x19A0,	0x1820,	0x1D20,	0x1CA0,	0x1E20,	0x1FA0,	
+		0x0A20,	0x0BA0,	0x0920,	0x08A0,	0x0DA0,	0x0C20,	0x0EA0,	0x0F20,	
+		0x0520,	0x04A0,	0x0620,	0x07A0,	0x02A0,	0x0320,	0x01A0,	0x0020,	
+		0xAA20,	0xABA0,	0xA920,	0xA8A0,	0xADA0,	0xAC20,	0xAEA0,	0xAF20,	
+		0xA520,	0xA4A0,	0xA620,	0xA7A0,	0xA2A0,	0xA320,	0xA1A0,	0xA020,	
+		0xB5A0,	0xB420,	0xB6A0,	0xB720,	0xB220,	0xB3A0,	0xB120,	0xB0A0,	
+		0xBAA0,	0xBB20,	0xB9A0,	0xB820,	0xBD20,	0xBCA0,	0xBE20,	0xBFA0,	
+		0x9520,	0x94A0,	0x9620,	0x97A0,	0x92A0,	0x9320,	0x91A0,	0x9020,	
+		0x9A20,	0x9BA0,	0x9920,	0x98A0,	0x9DA0,	0x9C20,	0x9EA0,	0x9F20,	
+		0x8AA0,	0x8B20,	0x89A0,	0x8820,	0x8D20,	0x8CA0,	0x8E20,	0x8FA0,	
+		0x85A0,	0x8420,	0x86A0,	0x8720,	0x8220,	0x83A0,	0x8120,	0x80A0,	
+		0xD5A0,	0xD420,	0xD6A0,	0xD720,	0xD220,	0xD3A0,	0xD120,	0xD0A0,	
+		0xDAA0,	0xDB20,	0xD9A0,	0xD820,	0xDD20,	0xDCA0,	0xDE20,	0xDFA0,	
+		0xCA20,	0xCBA0,	0xC920,	0xC8A0,	0xCDA0,	0xCC20,	0xCEA0,	0xCF20,	
+		0xC520,	0xC4A0,	0xC620,	0xC7A0,	0xC2A0,	0xC320,	0xC1A0,	0xC020,	
+		0xEAA0,	0xEB20,	0xE9A0,	0xE820,	0xED20,	0xECA0,	0xEE20,	0xEFA0,	
+		0xE5A0,	0xE420,	0xE6A0,	0xE720,	0xE220,	0xE3A0,	0xE120,	0xE0A0,	
+		0xF520,	0xF4A0,	0xF620,	0xF7A0,	0xF2A0,	0xF320,	0xF1A0,	0xF020,	
+		0xFA20,	0xFBA0,	0xF920,	0xF8A0,	0xFDA0,	0xFC20,	0xFEA0,	0xFF20
+	};
+								
+#else								
+	const u16 	uTxPrecodeTable[256] = 
+	{
+	  0x0020,  0x01A0,  0x02A0,  0x0320,  0x04A0,  0x0520,  0x0620,  0x07A0,
+	  0x08A0,  0x0920,  0x0A20,  0x0BA0,  0x0C20,  0x0DA0,  0x0EA0,  0x0F20,
+	  0x10A0,  0x1120,  0x1220,  0x13A0,  0x1420,  0x15A0,  0x16A0,  0x1720,
+	  0x1820,  0x19A0,  0x1AA0,  0x1B20,  0x1CA0,  0x1D20,  0x1E20,  0x1FA0,
+	  0x20A0,  0x2120,  0x2220,  0x23A0,  0x2420,  0x25A0,  0x26A0,  0x2720,
+	  0x2820,  0x29A0,  0x2AA0,  0x2B20,  0x2CA0,  0x2D20,  0x2E20,  0x2FA0,
+	  0x3020,  0x31A0,  0x32A0,  0x3320,  0x34A0,  0x3520,  0x3620,  0x37A0,
+	  0x38A0,  0x3920,  0x3A20,  0x3BA0,  0x3C20,  0x3DA0,  0x3EA0,  0x3F20,
+	  0x40A0,  0x4120,  0x4220,  0x43A0,  0x4420,  0x45A0,  0x46A0,  0x4720,
+	  0x4820,  0x49A0,  0x4AA0,  0x4B20,  0x4CA0,  0x4D20,  0x4E20,  0x4FA0,
+	  0x5020,  0x51A0,  0x52A0,  0x5320,  0x54A0,  0x5520,  0x5620,  0x57A0,
+	  0x58A0,  0x5920,  0x5A20,  0x5BA0,  0x5C20,  0x5DA0,  0x5EA0,  0x5F20,
+	  0x6020,  0x61A0,  0x62A0,  0x6320,  0x64A0,  0x6520,  0x6620,  0x67A0,
+	  0x68A0,  0x6920,  0x6A20,  0x6BA0,  0x6C20,  0x6DA0,  0x6EA0,  0x6F20,
+	  0x70A0,  0x7120,  0x7220,  0x73A0,  0x7420,  0x75A0,  0x76A0,  0x7720,
+	  0x7820,  0x79A0,  0x7AA0,  0x7B20,  0x7CA0,  0x7D20,  0x7E20,  0x7FA0,
+	  0x80A0,  0x8120,  0x8220,  0x83A0,  0x8420,  0x85A0,  0x86A0,  0x8720,
+	  0x8820,  0x89A0,  0x8AA0,  0x8B20,  0x8CA0,  0x8D20,  0x8E20,  0x8FA0,
+	  0x9020,  0x91A0,  0x92A0,  0x9320,  0x94A0,  0x9520,  0x9620,  0x97A0,
+	  0x98A0,  0x9920,  0x9A20,  0x9BA0,  0x9C20,  0x9DA0,  0x9EA0,  0x9F20,
+	  0xA020,  0xA1A0,  0xA2A0,  0xA320,  0xA4A0,  0xA520,  0xA620,  0xA7A0,
+	  0xA8A0,  0xA920,  0xAA20,  0xABA0,  0xAC20,  0xADA0,  0xAEA0,  0xAF20,
+	  0xB0A0,  0xB120,  0xB220,  0xB3A0,  0xB420,  0xB5A0,  0xB6A0,  0xB720,
+	  0xB820,  0xB9A0,  0xBAA0,  0xBB20,  0xBCA0,  0xBD20,  0xBE20,  0xBFA0,
+	  0xC020,  0xC1A0,  0xC2A0,  0xC320,  0xC4A0,  0xC520,  0xC620,  0xC7A0,
+	  0xC8A0,  0xC920,  0xCA20,  0xCBA0,  0xCC20,  0xCDA0,  0xCEA0,  0xCF20,
+	  0xD0A0,  0xD120,  0xD220,  0xD3A0,  0xD420,  0xD5A0,  0xD6A0,  0xD720,
+	  0xD820,  0xD9A0,  0xDAA0,  0xDB20,  0xDCA0,  0xDD20,  0xDE20,  0xDFA0,
+	  0xE0A0,  0xE120,  0xE220,  0xE3A0,  0xE420,  0xE5A0,  0xE6A0,  0xE720,
+	  0xE820,  0xE9A0,  0xEAA0,  0xEB20,  0xECA0,  0xED20,  0xEE20,  0xEFA0,
+	  0xF020,  0xF1A0,  0xF2A0,  0xF320,  0xF4A0,  0xF520,  0xF620,  0xF7A0,
+	  0xF8A0,  0xF920,  0xFA20,  0xFBA0,  0xFC20,  0xFDA0,  0xFEA0,  0xFF20
+	};
+#endif
+
+
 //==========================================================================================
 // Function:		InitializeGlobals()
 //
@@ -171,6 +260,7 @@ void InitializeGlobals()
 */
 
 	uCommandActive = 0;						// No serial command yet.
+	uCommandMulticast = False;
 	//uCalibActive = 0;						// Don't start calibrations yet.
 	// = PERIODS_PER_SEC;
 
@@ -198,6 +288,14 @@ void InitializeGlobals()
 		ulBerStats[i] = 0;
 	}
 	
+	// Clear mains phase statisitics to start.
+	memset(ulZcNoise, 0, sizeof(ulZcNoise));
+	memset(ulZcStats, 0, sizeof(ulZcStats));
+
+	// Clear link quality to start.
+	memset(&rxQuality, 0, sizeof(rxQuality));
+	memset(ulRxQualHist, 0, sizeof(ulRxQualHist));
+
 
 	//---- clear rxUserDataArray ------------------
 	memset(rxUserDataArray, 0, MAX_RX_MSG_LEN*sizeof(u16));
@@ -214,6 +312,8 @@ void InitializeGlobals()
 //                  New var uADCIntFlag.
 // 02/14/05 Hagen	Added uTraceIndex
 // 02/17/05 Hagen	changed uBerStats to ulBerStats
+// 19Oct26			uTxPrecodeTable[] moved here from transmit.h.  Removed the unused
+//					rxDataArray[].
 //==========================================================================================
 
 
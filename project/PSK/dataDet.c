@@ -35,8 +35,9 @@
 #define PLL_VHYST_THRS		1024   		// vertical bits
 #define PLL_THYST_THRS		4      		// time samples
 #define PLL_HOLD_THRS		110			// sample detBit signal above this point in pll.bitPhase
+#define PLL_INTEG_START		32			// start integrating phcos at this point in pll.bitPhase
+#define PLL_INTEG_SHIFT		3			// scale the bit integral down by this to get the soft bit
 
-#define AGC_THRS			(1500)		// control agcSignal to this amplitude 
 #define AGC_ENABLE			True		// turn on Automatic Gain Control
 
 
@@ -139,6 +140,12 @@ Revision History:
 01Feb05	Hagen	Created function
 25Feb05	Hagen	added more comments
 07Mar05	Hagen	changed gainIndex inc from -96  to -48
+19Oct26			replaced the per-sample gain walk with a fast-attack AGC: the raw signal
+				level is measured over AGC_WIN_LEN samples and sGainIndex jumps straight
+				to the gainTable entry that brings it to AGC_MEAN_TARGET.  The gain is
+				frozen by pll.agcHold once the preamble is found.
+19Oct26			agcMean kept in s32 (a full-scale mean does not fit s16); unused
+				agcSignal removed.
 ==========================================================================================*/
 s16 runPLL(s16 signal )
 {
@@ -147,9 +154,37 @@ s16 runPLL(s16 signal )
 	u16				tabIndex;
 	s16				bcos, bsin;
 	s32				signal32;
-	s16				agcSignal;
 	static s16		agcGain	= (1<<AGC_SCALE);
+	s32				agcMean;				// mean |signal|, up to 32768
+	s16				lo, mid, hi;
 	
+	//---- fast-attack AGC: measure the raw signal level over a window -------------
+	//     and jump to the gain that brings it to the target amplitude
+	#if AGC_ENABLE == True
+		if( ~pll.agcHold )
+		{
+			pll.agcSum += (signal < 0) ? -(s32)signal : (s32)signal;
+			if( ++pll.agcCount >= AGC_WIN_LEN )
+			{
+				agcMean = pll.agcSum >> AGC_WIN_SHIFT;
+				lo = 0;
+				hi = GAIN_TABLE_LEN-1;
+				while( lo < hi )		// binary search for the largest gain that keeps
+				{						// the mean level at or below the target
+					mid = (lo + hi + 1) >> 1;
+					if( ((agcMean * (s32)gainTable[mid]) >> AGC_SCALE) > AGC_MEAN_TARGET )
+						hi = mid - 1;
+					else
+						lo = mid;
+				}
+				pll.sGainIndex = lo << GAIN_TABLE_SCALE;
+				agcGain = gainTable[lo];
+				pll.agcSum = 0;
+				pll.agcCount = 0;
+			}
+		}
+	#endif
+
 	//---- apply AGC gain and do coarse gain adjust -------------
 	#if AGC_ENABLE == True
 		signal32 = ((s32)signal * (s32)agcGain) >>AGC_SCALE;
@@ -196,11 +231,7 @@ s16 runPLL(s16 signal )
 	pll.phcos -= sinBuf[pll.firCnt];
 	sinBuf[pll.firCnt] = (s16)( ( (s32)(bcos) * (s32)(signal) ) >> 16 );
 	pll.phcos += sinBuf[pll.firCnt];
-	#if AGC_ENABLE == True
-		agcSignal  = abs(sinBuf[pll.firCnt++]);
-	#else
-		pll.firCnt++;
-	#endif
+	pll.firCnt++;
 
 	pll.phsin -= sinBuf[pll.firCnt];
 	sinBuf[pll.firCnt] = (s16)( ( (s32)(bsin) * (s32)(signal) ) >> 16 );
@@ -226,33 +257,12 @@ s16 runPLL(s16 signal )
 	}	// end pll hold
 
 
-	#if AGC_ENABLE == True
-		//---- adjust signal amplitude -------------
-		if( ~pll.agcHold )
-		{
-			if( agcSignal < AGC_THRS )
-			{
-				pll.sGainIndex++;
-				if( pll.sGainIndex > ((GAIN_TABLE_LEN-1)<<GAIN_TABLE_SCALE) )
-					pll.sGainIndex = ((GAIN_TABLE_LEN-1)<<GAIN_TABLE_SCALE);
-			}
-			else   
-			{
-				pll.sGainIndex -= 2;
-				if( pll.sGainIndex < 0 )
-					pll.sGainIndex = 0;
-	
-			}	 //end gain adjust
-			agcGain = gainTable[pll.sGainIndex>>GAIN_TABLE_SCALE];
-		}	// end agc hold
-	#endif
 
 
 	//---- diagnostics ---------------------
 	#if TRACE_BUF_LEN > 0
 		#ifdef DSP_COMPILE
 			SaveTrace(signal);		 
-			//SaveTrace(agcSignal);		 
 		    SaveTrace(pll.phcos);   
 		    //SaveTrace(pherr);		
 			//SaveTrace(pll.bitPhase);	
@@ -267,7 +277,7 @@ s16 runPLL(s16 signal )
 			//SaveTrace( pll.intPhase );
 			//SaveTrace( pll.proPhase );
 			//SaveTrace( pll.eta );
-			SaveTrace(agcSignal);
+			SaveTrace(agcGain);
 		#endif
 	#endif
 
@@ -299,6 +309,9 @@ Revision History:
 				can start to look for a packet right after receiving one, but wait to TX.
 				Also changed FIND_BITSYNC bit window timeout to reset on too big and too small bit times
 07Mar05	Hagen	added Parity error check
+19Oct26			FIND_WORDSYNC and FIND_DATA decide each bit on the sign of phcos integrated
+				from PLL_INTEG_START to PLL_HOLD_THRS instead of a single detBit sample.
+				The magnitude of the integral is kept in uSoftBit.
 ==========================================================================================*/
 void receive(s16 ADCsample)
 {
@@ -307,9 +320,11 @@ void receive(s16 ADCsample)
 	static u16  detBit = 0;				// squared-up version of phase data
 	static s16  bitSample = False;		// flag used to sample detBit in FIND_DATA
 	static u16 	uEOP_holdOffCnt = 0;	// time to wait before transmitting
+	static s32	bitAcc = 0;				// integral of phcos over the bit window
 
 	s16			phcos;					// phase data out of digital PLL
 	u16			bitTransition = False;	// flag used to sample detBit in FIND_BITSYNC
+	u16			sliceBit = 0;			// bit decided from the sign of the bit integral
 	s16			diagSample = 0;			// flag used to generate trace data 
 	
 	
@@ -349,6 +364,25 @@ void receive(s16 ADCsample)
 		}
 	}
 
+
+	//---- integrate and dump phcos over the bit window -----------------
+	if( (pll.bitPhase >= PLL_INTEG_START) && (pll.bitPhase <= PLL_HOLD_THRS) )
+	{
+		bitAcc += phcos;
+	}
+	else if( (pll.bitPhase > PLL_HOLD_THRS) && (bitAcc != 0) )
+	{
+		sliceBit = (bitAcc >= 0) ? 1 : 0;
+		bitAcc = (bitAcc < 0) ? -bitAcc : bitAcc;
+		bitAcc >>= PLL_INTEG_SHIFT;
+		uSoftBit = (bitAcc > 0x7FFF) ? 0x7FFF : (u16)bitAcc;
+		bitAcc = 0;
+	}
+	else
+	{
+		sliceBit = detBit;		// no integral this window, fall back to detBit
+	}
+
 	
 	//---- look for information depending on state of modem -------------	
 	switch( uRxMode	)
@@ -414,7 +448,7 @@ void receive(s16 ADCsample)
 			if( bitSample )
 			{
 				bitSample = False;
-				detData = (detData << 1) | detBit;
+				detData = (detData << 1) | sliceBit;
 				diagSample = 1;
 
 				//---- look for WordSync ------------
@@ -479,7 +513,7 @@ void receive(s16 ADCsample)
 			if( bitSample )
 			{
 				bitSample = False;
-				detData = (detData << 1) | (detBit^pll.polarity);
+				detData = (detData << 1) | (sliceBit^pll.polarity);
 				diagSample = 1;
 
 				//---- process a byte of data ------------
@@ -613,6 +647,8 @@ void reset_to_BitSync(void)
 	pll.phsin = 0;
 	pll.sigPower = 0;
 	pll.agcHold = False;
+	pll.agcSum = 0;
+	pll.agcCount = 0;
 	pll.intPhase = 0;
 	pll.proPhase = 0;
 	pll.sGainIndex = GAIN_TABLE_UNITY_IX;
@@ -496,6 +496,8 @@ typedef struct
 	s16				sigPower;
 	s16				sGainIndex;
 	s16				agcHold;
+	s32				agcSum;		// fast-attack AGC: sum of |signal| over the window
+	u16				agcCount;	// fast-attack AGC: samples in the window so far
 }	pllControl;
 
 
@@ -574,6 +576,7 @@ extern u16	uCmd_EchoAck;					// toggle this var between BER achnowledge packets
 enum {RX_MODE, TX_MODE};
 extern u16	plcMode;						// Power Line Communications mode.  TX or RX
 extern u16	plcModeSnap;					// Snapshot of Power Line Communications mode.  TX or RX.
+extern u16	uSoftBit;						// Magnitude of the last bit decision integral (soft bit)
 
 #define USE_CRC				True			// calculate, transmit and compate at receive a 16 bit CRC
 #define	RECEIVE_OWN_XMIT	True			// Enable this line to allow us to receive our own transmitted signal		
@@ -597,9 +600,6 @@ extern u16	txUserDataArray[MAX_TX_MSG_LEN];// byte-wide buffer for user data
 #define	TX_ARRAY_LEN	((HEADER_LEN + MAX_TX_MSG_LEN*11 + CRCF_LEN + TRAILER_LEN + 15)/16)	
 extern u16	txDataArray[TX_ARRAY_LEN]; 			// word-wide byte-packed buffer for user transmit data, including headers, trailers, parity, and start/stop bits
 
-#define	RX_ARRAY_LEN	TX_ARRAY_LEN			// Make rx array same length as tx array.  Really could be shorter, since much of header is not stored
-extern u16	rxDataArray[RX_ARRAY_LEN];			// word-wide byte-packed buffer for user receive data, including headers, trailers, parity, and start/stop bits
-
 //---- define constants and buffer for debug counters -------------------
 #define PLC_STATS_LEN	(16*2*2)
 enum {	
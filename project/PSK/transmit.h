@@ -98,70 +98,6 @@ extern u16	txBitNext;			// Value of next bit to be sent via PLC
 extern u16 uRxModeCount;				// Number of negative values seen in the correlation output
 //==========================================================================================
 
-const u16	uParityTable[256] = {	0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0580,	0x01C0,	0x0500,	0x0140,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0140,	0x0500,	0x01C0,	0x0580,
-							0x0500,	0x0140,	0x0580,	0x01C0,
-							0x01C0,	0x0580,	0x0140,	0x0500,
-							0x0580,	0x01C0,	0x0500,	0x0140	};
 
 	// Transmitter pre-code table.  
 	// Pre-codes data so that differential detector spits out data directly.
@@ -245,34 +181,6 @@ const u16	uParityTable[256] = {	0x0140,	0x0500,	0x01C0,	0x0580,
 
 
 
-const q32	qlFIRTaps[FIR_LEN] = 
-{
- 	(     0L<<8<<8) |(      16383), //	 0.00000	   1.00000
-	(  4074L<<8<<8) |(      15868), //	 0.24869	   0.96858
-	(  7893L<<8<<8) |(      14357), //	 0.48175	   0.87631
-	( 11215L<<8<<8) |(      11943), //	 0.68455	   0.72897
-	( 13833L<<8<<8) |(       8778), //	 0.84433	   0.53583
-	( 15581L<<8<<8) |(       5063), //	 0.95106	   0.30902
-	( 16351L<<8<<8) |(       1029), //	 0.99803	   0.06279
-	( 16093L<<8<<8) |(65536 -3070), //	 0.98229	  -0.18738
-	( 14824L<<8<<8) |(65536 -6976), //	 0.90483	  -0.42578
-	( 12623L<<8<<8) |(65536-10443), //	 0.77051	  -0.63742
-	(  9630L<<8<<8) |(65536-13254), //	 0.58779	  -0.80902
-	(  6031L<<8<<8) |(65536-15233), //	 0.36812	  -0.92978
-	(  2053L<<8<<8) |(65536-16254), //	 0.12533	  -0.99211
-	( -2053L<<8<<8) |(65536-16254), //	-0.12533	  -0.99211
-	( -6031L<<8<<8) |(65536-15233), //	-0.36812	  -0.92978
-	( -9630L<<8<<8) |(65536-13254), //	-0.58779	  -0.80902
-	(-12623L<<8<<8) |(65536-10443), //	-0.77051	  -0.63742
-	(-14824L<<8<<8) |(65536 -6976), //	-0.90483	  -0.42578
-	(-16093L<<8<<8) |(65536 -3070), //	-0.98229	  -0.18738
-	(-16351L<<8<<8) |(       1029), //	-0.99803	   0.06279
-	(-15581L<<8<<8) |(       5063), //	-0.95106	   0.30902
-	(-13833L<<8<<8) |(       8778), //	-0.84433	   0.53583
-	(-11215L<<8<<8) |(      11943), //	-0.68455	   0.72897
-	( -7893L<<8<<8) |(      14357), //	-0.48175	   0.87631
-	( -4074L<<8<<8) |(      15868)  //	-0.24869	   0.96858	
-};
 
 
 
@@ -317,6 +225,7 @@ const q32	qlFIRTaps[FIR_LEN] =
 // 11/17/04	HEM		Removed rxBitPending.
 // 11/19/04	HEM		Moved ADCIntCount to main.h.
 // 07Mar05	Hagen	Made SaveTrace() same as in detData.h
+// 19Oct26			Removed the unused uParityTable[] and qlFIRTaps[].
 //==========================================================================================
 
 
@@ -80,6 +80,7 @@ u8	ubPhysicalMinLevel;				// const
 // Variables declared in plc.h
 u16		plcMode = RX_MODE;		// Power Line Communications mode.  TX or RX
 u16		plcModeSnap = RX_MODE;	// Power Line Communications mode.  TX or RX
+u16		uSoftBit = 0;			// Magnitude of the last bit decision integral (soft bit)
 u16		uRxMode = FIND_BITSYNC;	// PLC Receive Mode
 u16		T1PIntCount;			// EV Timer1 Period Interrupt counts
 //u16	T2PIntCount;			// EV Timer2 Period Interrupt counts
@@ -98,7 +99,6 @@ u16 	uRxModeCount=0;		// number of ADC INT counts we have been in a given rxMode
 u16		rxUserDataArray[MAX_RX_MSG_LEN];	// byte-wide buffer for user data
 u16		txUserDataArray[MAX_TX_MSG_LEN]; 	// byte-wide buffer for user data
 u16		txDataArray[TX_ARRAY_LEN]; 			// word-wide byte-packed buffer for user transmit data, including headers, trailers, parity, and start/stop bits
-u16 	rxDataArray[RX_ARRAY_LEN];			// word-wide byte-packed buffer for user receive data, including headers, trailers, parity, and start/stop bits
 
 u32		ulPlcStats[PLC_STATS_LEN/2/2][2];	// Statistics for PLC communication
 u32		ulBerStats[BER_STATS_LEN/2];		// Statistics for BER testing
@@ -209,6 +209,7 @@ void InitializeGlobals()
 //                  New var uADCIntFlag.
 // 02/14/05 Hagen	Added uTraceIndex
 // 02/17/05 Hagen	changed uBerStats to ulBerStats
+// 19Oct26			Removed the unused rxDataArray[].
 //==========================================================================================
 
 